@@ -13,6 +13,7 @@
 #include <ctime>
 #include <iterator>
 #include <locale>
+#include <memory>
 #include <ostream>
 #include <type_traits>
 
@@ -34,6 +35,12 @@ FMT_BEGIN_NAMESPACE
 #  endif
 #endif
 
+// Enable caching of the local time zone offset in fmt::localtime. Disabled by
+// default because the cache ignores time zone changes at run time.
+#ifndef FMT_USE_LOCALTIME_CACHE
+#  define FMT_USE_LOCALTIME_CACHE 0
+#endif
+
 // Enable safe chrono durations, unless explicitly disabled.
 #ifndef FMT_SAFE_DURATION_CAST
 #  define FMT_SAFE_DURATION_CAST 1
@@ -438,6 +445,152 @@ auto write(OutputIt out, const std::tm& time, const std::locale& loc,
   return write_encoded_tm_str(out, string_view(buf.data(), buf.size()), loc);
 }
 
+// Returns the number of days since 1970-01-01 of the date in the proleptic
+// Gregorian calendar. The algorithm is from
+// https://howardhinnant.github.io/date_algorithms.html.
+FMT_CONSTEXPR inline auto days_from_civil(long long year, int month, int day)
+    -> long long {
+  year -= month <= 2;
+  auto era = (year >= 0 ? year : year - 399) / 400;
+  auto yoe = static_cast<unsigned>(year - era * 400);  // [0, 399]
+  auto doy = to_unsigned((153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 +
+                         day - 1);                        // [0, 365]
+  auto doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;       // [0, 146096]
+  return era * 146097 + static_cast<long long>(doe) - 719468;
+}
+
+struct civil_date {
+  long long year;
+  int month;  // [1, 12]
+  int day;    // [1, 31]
+};
+
+// Returns the date that is the given number of days since 1970-01-01.
+// Inverse of days_from_civil.
+FMT_CONSTEXPR inline auto civil_from_days(long long days) -> civil_date {
+  auto z = days + 719468;
+  auto era = (z >= 0 ? z : z - 146096) / 146097;
+  auto doe = static_cast<unsigned>(z - era * 146097);  // [0, 146096]
+  auto yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+  auto doy = doe - (365 * yoe + yoe / 4 - yoe / 100);  // [0, 365]
+  auto mp = (5 * doy + 2) / 153;                       // [0, 11]
+  auto month = static_cast<int>(mp < 10 ? mp + 3 : mp - 9);
+  auto year = static_cast<long long>(yoe) + era * 400 + (month <= 2);
+  return {year, month, static_cast<int>(doy - (153 * mp + 2) / 5 + 1)};
+}
+
+// Converts seconds since 1970-01-01 00:00:00 to the date and time fields of
+// tm, leaving the other fields unchanged.
+FMT_CONSTEXPR inline void seconds_to_tm(long long seconds, std::tm& tm) {
+  const long long seconds_per_day = 86400;
+  auto days = seconds / seconds_per_day;
+  auto secs = static_cast<int>(seconds % seconds_per_day);
+  if (secs < 0) {
+    secs += static_cast<int>(seconds_per_day);
+    --days;
+  }
+  tm.tm_hour = secs / 3600;
+  tm.tm_min = secs / 60 % 60;
+  tm.tm_sec = secs % 60;
+  tm.tm_wday = static_cast<int>((days % 7 + 11) % 7);  // 1970-01-01 is Thu.
+  auto date = civil_from_days(days);
+  tm.tm_year = static_cast<int>(date.year - 1900);
+  tm.tm_mon = date.month - 1;
+  tm.tm_mday = date.day;
+  tm.tm_yday = static_cast<int>(days - days_from_civil(date.year, 1, 1));
+}
+
+// Returns the offset from UTC in seconds of the local time tm corresponding to
+// time.
+inline auto utc_offset(std::time_t time, const std::tm& tm) -> long long {
+  auto local = days_from_civil(1900ll + tm.tm_year, tm.tm_mon + 1, tm.tm_mday);
+  return local * 86400 + tm.tm_hour * 3600 + tm.tm_min * 60 + tm.tm_sec -
+         static_cast<long long>(time);
+}
+
+template <typename T, typename = void>
+struct has_member_data_tm_gmtoff : std::false_type {};
+template <typename T>
+struct has_member_data_tm_gmtoff<T, void_t<decltype(T::tm_gmtoff)>>
+    : std::true_type {};
+
+template <typename T, typename = void>
+struct has_member_data_tm_zone : std::false_type {};
+template <typename T>
+struct has_member_data_tm_zone<T, void_t<decltype(T::tm_zone)>>
+    : std::true_type {};
+
+template <typename T, FMT_ENABLE_IF(has_member_data_tm_zone<T>::value)>
+auto same_tz_name(const T& lhs, const T& rhs) -> bool {
+  return lhs.tm_zone == rhs.tm_zone ||
+         (lhs.tm_zone && rhs.tm_zone &&
+          std::strcmp(lhs.tm_zone, rhs.tm_zone) == 0);
+}
+template <typename T, FMT_ENABLE_IF(!has_member_data_tm_zone<T>::value)>
+auto same_tz_name(const T&, const T&) -> bool {
+  return true;
+}
+
+// A range of times [begin, end) in which the local time zone has the same UTC
+// offset, DST flag and name. tm holds the C library conversion of a time in the
+// range and provides the fields other than date and time, e.g. tm_zone.
+struct localtime_range {
+  std::time_t begin = 1;
+  std::time_t end = 0;
+  long long offset = 0;
+  std::tm tm = std::tm();
+};
+
+// Finds the range around time using the C library conversion f. The offset is
+// assumed to not change more than once within a day, which holds for all real
+// time zones.
+template <typename F>
+auto find_localtime_range(std::time_t time, F f, localtime_range& range)
+    -> bool {
+  auto tm = std::tm();
+  // Leap seconds can't be represented by an offset.
+  if (!f(time, tm) || tm.tm_sec > 59) return false;
+  auto offset = utc_offset(time, tm);
+  auto same = [&](std::time_t t) {
+    auto other = std::tm();
+    return f(t, other) && other.tm_isdst == tm.tm_isdst &&
+           utc_offset(t, other) == offset && same_tz_name(other, tm);
+  };
+  const std::time_t day = 86400;
+  // Binary search for the first time with a different offset in (lo, hi].
+  auto find_change = [&](std::time_t lo, std::time_t hi, bool lo_same) {
+    while (hi - lo > 1) {
+      auto mid = lo + (hi - lo) / 2;
+      if (same(mid) == lo_same)
+        lo = mid;
+      else
+        hi = mid;
+    }
+    return hi;
+  };
+  range.end =
+      same(time + day) ? time + day : find_change(time, time + day, true);
+  range.begin =
+      same(time - day) ? time - day : find_change(time - day, time, false);
+  range.offset = offset;
+  range.tm = tm;
+  return true;
+}
+
+// Converts time to local time using an offset cached per thread and calls the
+// C library conversion f only when time is outside of the cached range.
+// Returns false if the conversion failed.
+template <typename F>
+auto cached_localtime(std::time_t time, F f, std::tm& tm) -> bool {
+  static thread_local localtime_range range;
+  if (time < range.begin || time >= range.end) {
+    if (!find_localtime_range(time, f, range)) return false;
+  }
+  tm = range.tm;
+  seconds_to_tm(static_cast<long long>(time) + range.offset, tm);
+  return true;
+}
+
 }  // namespace detail
 
 FMT_MODULE_EXPORT_BEGIN
@@ -446,6 +599,17 @@ FMT_MODULE_EXPORT_BEGIN
   Converts given time since epoch as ``std::time_t`` value into calendar time,
   expressed in local time. Unlike ``std::localtime``, this function is
   thread-safe on most platforms.
+
+  If ``FMT_USE_LOCALTIME_CACHE`` is defined to 1, the UTC offset is cached per
+  thread together with the range of times it applies to, so that calls for
+  nearby times don't go through the C library. This has two trade-offs:
+
+  * The cache is never invalidated, so a change of the time zone at run time,
+    for example with ``setenv("TZ", ...)`` and ``tzset()``, is ignored for
+    times within a cached range.
+  * Finding the range takes several more C library conversions than a single
+    uncached call, so calls that jump between days are slower than without
+    the cache.
  */
 inline std::tm localtime(std::time_t time) {
   struct dispatcher {
@@ -477,6 +641,16 @@ inline std::tm localtime(std::time_t time) {
     }
 #endif
   };
+#if FMT_USE_LOCALTIME_CACHE
+  auto tm = std::tm();
+  auto convert = [](std::time_t t, std::tm& result) {
+    dispatcher d(t);
+    if (!d.run()) return false;
+    result = d.tm_;
+    return true;
+  };
+  if (detail::cached_localtime(time, convert, tm)) return tm;
+#endif
   dispatcher lt(time);
   // Too big time values may be unsupported.
   if (!lt.run()) FMT_THROW(format_error("time_t value out of range"));
@@ -561,6 +735,72 @@ inline void write_digit2_separated(char* buf, unsigned a, unsigned b,
   memcpy(buf, &digits, 8);
 }
 
+// Returns the number of seconds since the epoch of a time point rounded down.
+template <typename Duration>
+auto floor_seconds(
+    std::chrono::time_point<std::chrono::system_clock, Duration> time)
+    -> long long {
+  using std::chrono::seconds;
+  auto d = time.time_since_epoch();
+  auto secs = std::chrono::duration_cast<seconds>(d);
+  if (secs > d) secs -= seconds(1);
+  return static_cast<long long>(secs.count());
+}
+
+// Writes the UTC time seconds since 1970-01-01 00:00:00 in the ISO 8601 format
+// YYYY-MM-DDThh:mm:ss[.f]Z where f is fraction written with num_digits digits.
+template <typename Char, typename OutputIt>
+auto write_iso8601(OutputIt out, long long seconds, uint64_t fraction,
+                   int num_digits) -> OutputIt {
+  const long long seconds_per_day = 86400;
+  auto days = seconds / seconds_per_day;
+  auto secs = static_cast<int>(seconds % seconds_per_day);
+  if (secs < 0) {
+    secs += static_cast<int>(seconds_per_day);
+    --days;
+  }
+  auto date = civil_from_days(days);
+
+  // The longest output is -292277026596-12-04T15:30:07.000000000000000000Z.
+  char buf[64];
+  char* p = buf;
+  if (date.year >= 0 && date.year < 10000) {
+    copy2(p, digits2(static_cast<size_t>(date.year / 100)));
+    copy2(p + 2, digits2(static_cast<size_t>(date.year % 100)));
+    p += 4;
+  } else {
+    // At least 4 characters as in %Y.
+    int width = 4;
+    auto year = date.year;
+    if (year < 0) {
+      *p++ = '-';
+      year = 0 - year;
+      --width;
+    }
+    uint32_or_64_or_128_t<long long> n = to_unsigned(year);
+    int num_year_digits = count_digits(n);
+    for (int i = num_year_digits; i < width; ++i) *p++ = '0';
+    p = format_decimal<char>(p, n, num_year_digits).end;
+  }
+  *p++ = '-';
+  copy2(p, digits2(to_unsigned(date.month)));
+  p[2] = '-';
+  copy2(p + 3, digits2(to_unsigned(date.day)));
+  p[5] = 'T';
+  write_digit2_separated(p + 6, to_unsigned(secs / 3600),
+                         to_unsigned(secs / 60 % 60), to_unsigned(secs % 60),
+                         ':');
+  p += 14;
+  if (num_digits > 0) {
+    *p++ = '.';
+    std::fill_n(p, num_digits, '0');
+    format_decimal<char>(p, fraction, num_digits);
+    p += num_digits;
+  }
+  *p++ = 'Z';
+  return copy_str<Char>(buf, p, out);
+}
+
 template <typename Period> FMT_CONSTEXPR inline const char* get_units() {
   if (std::is_same<Period, std::atto>::value) return "as";
   if (std::is_same<Period, std::femto>::value) return "fs";
@@ -900,43 +1140,92 @@ struct tm_format_checker : null_chrono_spec_handler<tm_format_checker> {
   FMT_CONSTEXPR void on_tz_name() {}
 };
 
-inline const char* tm_wday_full_name(int wday) {
-  static constexpr const char* full_name_list[] = {
+// Weekday and month names of the classic locale.
+template <typename T = void> struct classic_tm_names {
+  static constexpr const char* full_weekday[] = {
       "Sunday",   "Monday", "Tuesday", "Wednesday",
       "Thursday", "Friday", "Saturday"};
-  return wday >= 0 && wday <= 6 ? full_name_list[wday] : "?";
-}
-inline const char* tm_wday_short_name(int wday) {
-  static constexpr const char* short_name_list[] = {"Sun", "Mon", "Tue", "Wed",
-                                                    "Thu", "Fri", "Sat"};
-  return wday >= 0 && wday <= 6 ? short_name_list[wday] : "???";
-}
-
-inline const char* tm_mon_full_name(int mon) {
-  static constexpr const char* full_name_list[] = {
+  static constexpr const char* short_weekday[] = {"Sun", "Mon", "Tue", "Wed",
+                                                  "Thu", "Fri", "Sat"};
+  static constexpr const char* full_month[] = {
       "January", "February", "March",     "April",   "May",      "June",
       "July",    "August",   "September", "October", "November", "December"};
-  return mon >= 0 && mon <= 11 ? full_name_list[mon] : "?";
-}
-inline const char* tm_mon_short_name(int mon) {
-  static constexpr const char* short_name_list[] = {
+  static constexpr const char* short_month[] = {
       "Jan", "Feb", "Mar", "Apr", "May", "Jun",
       "Jul", "Aug", "Sep", "Oct", "Nov", "Dec",
   };
-  return mon >= 0 && mon <= 11 ? short_name_list[mon] : "???";
+};
+template <typename T> constexpr const char* classic_tm_names<T>::full_weekday[];
+template <typename T>
+constexpr const char* classic_tm_names<T>::short_weekday[];
+template <typename T> constexpr const char* classic_tm_names<T>::full_month[];
+template <typename T> constexpr const char* classic_tm_names<T>::short_month[];
+
+FMT_CONSTEXPR inline const char* tm_wday_full_name(int wday) {
+  return wday >= 0 && wday <= 6 ? classic_tm_names<>::full_weekday[wday] : "?";
+}
+FMT_CONSTEXPR inline const char* tm_wday_short_name(int wday) {
+  return wday >= 0 && wday <= 6 ? classic_tm_names<>::short_weekday[wday]
+                                : "???";
 }
 
-template <typename T, typename = void>
-struct has_member_data_tm_gmtoff : std::false_type {};
-template <typename T>
-struct has_member_data_tm_gmtoff<T, void_t<decltype(T::tm_gmtoff)>>
-    : std::true_type {};
+FMT_CONSTEXPR inline const char* tm_mon_full_name(int mon) {
+  return mon >= 0 && mon <= 11 ? classic_tm_names<>::full_month[mon] : "?";
+}
+FMT_CONSTEXPR inline const char* tm_mon_short_name(int mon) {
+  return mon >= 0 && mon <= 11 ? classic_tm_names<>::short_month[mon] : "???";
+}
 
-template <typename T, typename = void>
-struct has_member_data_tm_zone : std::false_type {};
-template <typename T>
-struct has_member_data_tm_zone<T, void_t<decltype(T::tm_zone)>>
-    : std::true_type {};
+// Weekday, month and AM/PM names of a locale. They are obtained from
+// std::time_put once and encoded the same way as by write() so that they can
+// be copied to the output directly.
+template <typename Char> struct locale_tm_names {
+  using string_type = std::basic_string<Char>;
+
+  string_type short_weekday[7];
+  string_type full_weekday[7];
+  string_type short_month[12];
+  string_type full_month[12];
+  string_type am_pm[2];
+
+  explicit locale_tm_names(const std::locale& loc) {
+    auto tm = std::tm();
+    tm.tm_mday = 1;
+    auto put = [&](string_type& name, char format) {
+      write<Char>(std::back_inserter(name), tm, loc, format);
+    };
+    for (int i = 0; i < 7; ++i) {
+      tm.tm_wday = i;
+      put(short_weekday[i], 'a');
+      put(full_weekday[i], 'A');
+    }
+    for (int i = 0; i < 12; ++i) {
+      tm.tm_mon = i;
+      put(short_month[i], 'b');
+      put(full_month[i], 'B');
+    }
+    for (int i = 0; i < 2; ++i) {
+      tm.tm_hour = i * 12;
+      put(am_pm[i], 'p');
+    }
+  }
+};
+
+// Returns the names for loc caching them for the last used locale per thread.
+// The reference is valid until the next call on the same thread.
+template <typename Char>
+auto get_locale_tm_names(const std::locale& loc)
+    -> const locale_tm_names<Char>& {
+  struct entry {
+    std::locale loc;
+    locale_tm_names<Char> names;
+
+    explicit entry(const std::locale& l) : loc(l), names(l) {}
+  };
+  static thread_local std::unique_ptr<entry> cache;
+  if (!cache || cache->loc != loc) cache.reset(new entry(loc));
+  return cache->names;
+}
 
 #if FMT_USE_TZSET
 inline void tzset_once() {
@@ -1116,6 +1405,18 @@ template <typename OutputIt, typename Char> class tm_writer {
     out_ = write<Char>(out_, tm_, loc_, format, modifier);
   }
 
+  void write_name(const std::basic_string<Char>& name) {
+    out_ = copy_str<Char>(name.data(), name.data() + name.size(), out_);
+  }
+  // Writes names[index] or "?" if index is out of range like strftime.
+  template <size_t N>
+  void write_name(const std::basic_string<Char> (&names)[N], int index) {
+    if (index >= 0 && index < static_cast<int>(N))
+      write_name(names[index]);
+    else
+      *out_++ = '?';
+  }
+
  public:
   tm_writer(const std::locale& loc, OutputIt out, const std::tm& tm)
       : loc_(loc),
@@ -1133,13 +1434,13 @@ template <typename OutputIt, typename Char> class tm_writer {
     if (is_classic_)
       out_ = write(out_, tm_wday_short_name(tm_wday()));
     else
-      format_localized('a');
+      write_name(get_locale_tm_names<Char>(loc_).short_weekday, tm_wday());
   }
   void on_full_weekday() {
     if (is_classic_)
       out_ = write(out_, tm_wday_full_name(tm_wday()));
     else
-      format_localized('A');
+      write_name(get_locale_tm_names<Char>(loc_).full_weekday, tm_wday());
   }
   void on_dec0_weekday(numeric_system ns) {
     if (is_classic_ || ns == numeric_system::standard) return write1(tm_wday());
@@ -1158,13 +1459,13 @@ template <typename OutputIt, typename Char> class tm_writer {
     if (is_classic_)
       out_ = write(out_, tm_mon_short_name(tm_mon()));
     else
-      format_localized('b');
+      write_name(get_locale_tm_names<Char>(loc_).short_month, tm_mon());
   }
   void on_full_month() {
     if (is_classic_)
       out_ = write(out_, tm_mon_full_name(tm_mon()));
     else
-      format_localized('B');
+      write_name(get_locale_tm_names<Char>(loc_).full_month, tm_mon());
   }
 
   void on_datetime(numeric_system ns) {
@@ -1353,7 +1654,7 @@ template <typename OutputIt, typename Char> class tm_writer {
       *out_++ = tm_hour() < 12 ? 'A' : 'P';
       *out_++ = 'M';
     } else {
-      format_localized('p');
+      write_name(get_locale_tm_names<Char>(loc_).am_pm[tm_hour() < 12 ? 0 : 1]);
     }
   }
 
@@ -1362,6 +1663,107 @@ template <typename OutputIt, typename Char> class tm_writer {
   void on_duration_unit() {}
 };
 
+// A position of a two-character time of day field in formatted text.
+struct time_field {
+  enum kind_type : unsigned char { hour, hour12, minute, second, am_pm };
+  size_t offset;
+  kind_type kind;
+};
+
+// Writes the value of field for the time sec seconds since midnight to text.
+inline void write_time_field(char* text, time_field field, int sec) {
+  char* p = text + field.offset;
+  auto hour = sec / 3600;
+  switch (field.kind) {
+  case time_field::hour:
+    return copy2(p, digits2(to_unsigned(hour)));
+  case time_field::hour12:
+    return copy2(p, digits2(to_unsigned(hour % 12 == 0 ? 12 : hour % 12)));
+  case time_field::minute:
+    return copy2(p, digits2(to_unsigned(sec / 60 % 60)));
+  case time_field::second:
+    return copy2(p, digits2(to_unsigned(sec % 60)));
+  case time_field::am_pm:
+    *p = hour < 12 ? 'A' : 'P';
+    return;
+  }
+}
+
+// A tm_writer using the classic locale that records the positions of the
+// time of day fields it writes so that they can be updated in place.
+class timestamp_writer : public tm_writer<appender, char> {
+ private:
+  using base = tm_writer<appender, char>;
+
+  buffer<char>& buf_;
+  buffer<time_field>& fields_;
+
+  void add(size_t offset, time_field::kind_type kind) {
+    fields_.push_back({buf_.size() + offset, kind});
+  }
+  // "hh:mm:ss" starting at offset.
+  void add_iso_time(size_t offset) {
+    add(offset, time_field::hour);
+    add(offset + 3, time_field::minute);
+    add(offset + 6, time_field::second);
+  }
+
+ public:
+  timestamp_writer(buffer<char>& buf, const std::tm& tm,
+                   buffer<time_field>& fields)
+      : base(get_classic_locale(), appender(buf), tm),
+        buf_(buf),
+        fields_(fields) {}
+
+  void on_24_hour(numeric_system ns) {
+    add(0, time_field::hour);
+    base::on_24_hour(ns);
+  }
+  void on_12_hour(numeric_system ns) {
+    add(0, time_field::hour12);
+    base::on_12_hour(ns);
+  }
+  void on_minute(numeric_system ns) {
+    add(0, time_field::minute);
+    base::on_minute(ns);
+  }
+  void on_second(numeric_system ns) {
+    add(0, time_field::second);
+    base::on_second(ns);
+  }
+  void on_am_pm() {
+    add(0, time_field::am_pm);
+    base::on_am_pm();
+  }
+  // "Www Mmm dd hh:mm:ss yyyy" in the classic locale.
+  void on_datetime(numeric_system ns) {
+    add_iso_time(11);
+    base::on_datetime(ns);
+  }
+  // "hh:mm:ss" in the classic locale.
+  void on_loc_time(numeric_system ns) {
+    add_iso_time(0);
+    base::on_loc_time(ns);
+  }
+  // "hh:mm:ss AM" in the classic locale.
+  void on_12_hour_time() {
+    add(0, time_field::hour12);
+    add(3, time_field::minute);
+    add(6, time_field::second);
+    add(9, time_field::am_pm);
+    base::on_12_hour_time();
+  }
+  void on_24_hour_time() {
+    add(0, time_field::hour);
+    add(3, time_field::minute);
+    base::on_24_hour_time();
+  }
+  void on_iso_time() {
+    add_iso_time(0);
+    base::on_iso_time();
+  }
+};
+
 struct chrono_format_checker : null_chrono_spec_handler<chrono_format_checker> {
   FMT_NORETURN void unsupported() { FMT_THROW(format_error("no date")); }
 
@@ -1468,7 +1870,7 @@ inline std::chrono::duration<Rep, std::milli> get_milliseconds(
 constexpr int count_fractional_digits(long long num, long long den, int n = 0) {
   return num % den == 0
              ? n
-             : (n > 18 ? 6 : count_fractional_digits(num * 10, den, n + 1));
+             : (n >= 18 ? 6 : count_fractional_digits(num * 10, den, n + 1));
 }
 
 constexpr long long pow10(std::uint32_t n) {
@@ -1511,6 +1913,32 @@ OutputIt format_duration_value(OutputIt out, Rep val, int precision) {
   return write<Char>(out, val, specs);
 }
 
+// Writes nonnegative seconds modulo 60 as two digits and precision fractional
+// digits rounded to nearest from the exact value like "{:.3f}". Rounding
+// carries into the seconds field only, so 59.9996 with precision 3 is written
+// as 60.000 like a leap second and the minutes are not changed.
+template <typename Char, typename Rep, typename OutputIt,
+          FMT_ENABLE_IF(std::is_floating_point<Rep>::value)>
+OutputIt write_seconds(OutputIt out, Rep seconds, int precision) {
+  auto buf = basic_memory_buffer<Char>();
+  auto specs = basic_format_specs<Char>();
+  specs.precision = precision;
+  specs.type = presentation_type::fixed_lower;
+  write<Char>(buffer_appender<Char>(buf),
+              std::fmod(seconds, static_cast<Rep>(60)), specs);
+  auto num_int_digits =
+      buf.size() - (precision > 0 ? to_unsigned(precision) + 1 : 0);
+  if (num_int_digits < 2) *out++ = '0';
+  return copy_str<Char>(buf.begin(), buf.end(), out);
+}
+
+// Precision is not allowed for integral durations.
+template <typename Char, typename Rep, typename OutputIt,
+          FMT_ENABLE_IF(std::is_integral<Rep>::value)>
+OutputIt write_seconds(OutputIt out, Rep, int) {
+  return out;
+}
+
 template <typename Char, typename OutputIt>
 OutputIt copy_unit(string_view unit, OutputIt out, Char) {
   return std::copy(unit.begin(), unit.end(), out);
@@ -1762,6 +2190,11 @@ struct chrono_formatter {
     if (handle_nan_inf()) return;
 
     if (ns == numeric_system::standard) {
+      if (precision >= 0) {
+        write_sign();
+        out = detail::write_seconds<char_type>(out, s.count(), precision);
+        return;
+      }
       write(second(), 2);
       write_fractional_seconds(std::chrono::duration<rep, Period>{val});
       return;
@@ -2053,6 +2486,215 @@ template <typename Char> struct formatter<std::tm, Char> {
   }
 };
 
+template <typename Duration> struct iso8601_view {
+  std::chrono::time_point<std::chrono::system_clock, Duration> time;
+};
+
+/**
+  \rst
+  Returns a view that formats a system clock time point as UTC time in the
+  ISO 8601 (RFC 3339) format ``YYYY-MM-DDThh:mm:ss[.f]Z``. The fraction of a
+  second has the same number of digits as ``%S`` gives the time point's
+  duration, e.g. 3 for milliseconds and 9 for nanoseconds, and is omitted for
+  durations of whole seconds. Unlike ``fmt::gmtime``, it uses only integer
+  arithmetic and doesn't go through ``std::tm``. The format spec may only
+  contain fill, align and width such as ``{:>30}``.
+
+  **Example**::
+
+    auto t = std::chrono::time_point_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now());
+    fmt::print("{}", fmt::iso8601(t));
+    // Output: 2022-01-17T12:34:56.789Z
+  \endrst
+ */
+template <typename Duration,
+          FMT_ENABLE_IF(std::is_integral<typename Duration::rep>::value)>
+auto iso8601(std::chrono::time_point<std::chrono::system_clock, Duration> time)
+    -> iso8601_view<Duration> {
+  return {time};
+}
+
+template <typename Duration, typename Char>
+struct formatter<iso8601_view<Duration>, Char> {
+ private:
+  detail::dynamic_format_specs<Char> specs_;
+
+ public:
+  // Parses the fill, align and width, the only specs that iso8601 takes.
+  template <typename ParseContext>
+  FMT_CONSTEXPR auto parse(ParseContext& ctx) -> decltype(ctx.begin()) {
+    auto begin = ctx.begin(), end = ctx.end();
+    if (begin == end || *begin == '}') return begin;
+    auto handler = detail::dynamic_specs_handler<ParseContext>(specs_, ctx);
+    begin = detail::parse_align(begin, end, handler);
+    if (begin != end) begin = detail::parse_width(begin, end, handler);
+    if (begin != end && *begin != '}')
+      handler.on_error("iso8601 takes only fill, align and width");
+    return begin;
+  }
+
+  template <typename FormatContext>
+  auto format(iso8601_view<Duration> view, FormatContext& ctx) const
+      -> decltype(ctx.out()) {
+    auto specs = specs_;
+    detail::handle_dynamic_spec<detail::width_checker>(specs.width,
+                                                       specs.width_ref, ctx);
+    using std::chrono::seconds;
+    constexpr auto num_digits = detail::count_fractional_digits(
+        Duration::period::num, Duration::period::den);
+    using fraction = std::chrono::duration<
+        long long, std::ratio<1, detail::pow10(num_digits)>>;
+    auto secs = detail::floor_seconds(view.time);
+    // Subtracting secs from the time could overflow near the minimum time.
+    auto d = view.time.time_since_epoch() % seconds(1);
+    if (d < d.zero()) d += seconds(1);
+    auto frac = std::chrono::duration_cast<fraction>(d).count();
+    if (specs.width == 0) {
+      return detail::write_iso8601<Char>(
+          ctx.out(), secs, static_cast<uint64_t>(frac), num_digits);
+    }
+    auto buf = basic_memory_buffer<Char, 64>();
+    detail::write_iso8601<Char>(detail::buffer_appender<Char>(buf), secs,
+                                static_cast<uint64_t>(frac), num_digits);
+    return detail::write(
+        ctx.out(), basic_string_view<Char>(buf.data(), buf.size()), specs);
+  }
+};
+
+/**
+  \rst
+  A cache of formatted timestamps for log lines that are mostly written within
+  the same minute. The text is formatted once per minute and later times in
+  that minute only rewrite the seconds digits. The format string has the same
+  syntax as the ``std::tm`` format specification, times are converted with
+  `fmt::localtime` and formatted using the classic locale.
+
+  The cache is not thread-safe, use one per thread, e.g. ``thread_local``.
+
+  **Example**::
+
+    thread_local auto cache = fmt::timestamp_cache("%Y-%m-%d %H:%M:%S");
+    fmt::print("{} {}\n", cache.format(std::chrono::system_clock::now()), msg);
+  \endrst
+ */
+class timestamp_cache {
+ private:
+  std::string format_str_;
+  basic_memory_buffer<char, 64> buf_;
+  // Positions of the time of day fields in buf_.
+  basic_memory_buffer<detail::time_field, 4> fields_;
+  std::time_t time_ = 0;
+  // Seconds of time_ or -1 if nothing has been formatted yet.
+  long sec_ = -1;
+
+ public:
+  explicit timestamp_cache(string_view format_str = "%F %T")
+      : format_str_(format_str.data(), format_str.size()) {
+    detail::parse_chrono_format(format_str.begin(), format_str.end(),
+                                detail::tm_format_checker());
+  }
+
+  /**
+    Returns the formatted time. The result is valid until the next call.
+   */
+  auto format(std::time_t time) -> string_view {
+    auto sec = static_cast<long>(sec_ + (time - time_));
+    if (sec_ < 0 || sec < 0 || sec >= 60) {
+      auto tm = localtime(time);
+      buf_.clear();
+      fields_.clear();
+      auto w = detail::timestamp_writer(buf_, tm, fields_);
+      detail::parse_chrono_format(
+          format_str_.data(), format_str_.data() + format_str_.size(), w);
+      sec = tm.tm_sec;
+    } else if (sec != sec_) {
+      auto digits = detail::digits2(detail::to_unsigned(sec));
+      for (auto field : fields_) {
+        if (field.kind == detail::time_field::second)
+          detail::copy2(buf_.data() + field.offset, digits);
+      }
+    }
+    time_ = time;
+    sec_ = sec;
+    return {buf_.data(), buf_.size()};
+  }
+
+  auto format(std::chrono::time_point<std::chrono::system_clock> time)
+      -> string_view {
+    return format(std::chrono::system_clock::to_time_t(time));
+  }
+};
+
+/**
+  \rst
+  Formats system clock time points in the range [*begin*, *end*) as UTC times
+  using the ``std::tm`` format specification *format_str* and the classic locale
+  and appends each of them followed by *sep* to the memory buffer *buf*. The
+  text is formatted once per day and the hours, minutes, seconds and AM/PM are
+  updated in place for the other times of that day, so columns of times that
+  are mostly in the same day are formatted much faster than with a separate
+  call per time.
+
+  **Example**::
+
+    auto buf = fmt::memory_buffer();
+    fmt::format_utc_times(buf, times.begin(), times.end(), "%Y-%m-%d %H:%M:%S");
+  \endrst
+ */
+template <typename InputIt, size_t SIZE, typename Allocator>
+void format_utc_times(basic_memory_buffer<char, SIZE, Allocator>& buf,
+                      InputIt begin, InputIt end,
+                      string_view format_str = "%F %T",
+                      string_view sep = "\n") {
+  detail::parse_chrono_format(format_str.begin(), format_str.end(),
+                              detail::tm_format_checker());
+  const long long seconds_per_day = 86400;
+  // The time zone fields of UTC which seconds_to_tm leaves unchanged.
+  auto tm = gmtime(0);
+  // The text for the current day and the positions of its time of day fields.
+  auto day_text = basic_memory_buffer<char, 64>();
+  auto fields = basic_memory_buffer<detail::time_field, 4>();
+  auto day = (std::numeric_limits<long long>::min)();
+  enum { block_size = 64 };
+  long long days[block_size];
+  int secs[block_size];
+  while (begin != end) {
+    int n = 0;
+    for (; n < block_size && begin != end; ++n, ++begin)
+      days[n] = detail::floor_seconds(*begin);
+    // Split into days and seconds since midnight. There are no branches so
+    // that the loop can be vectorized.
+    for (int i = 0; i < n; ++i) {
+      auto d = days[i] / seconds_per_day;
+      auto s = days[i] - d * seconds_per_day;
+      auto borrow = static_cast<long long>(s < 0);
+      days[i] = d - borrow;
+      secs[i] = static_cast<int>(s + borrow * seconds_per_day);
+    }
+    for (int i = 0; i < n; ++i) {
+      if (days[i] != day) {
+        day = days[i];
+        auto year = detail::civil_from_days(day).year - 1900;
+        if (year < (std::numeric_limits<int>::min)() ||
+            year > (std::numeric_limits<int>::max)()) {
+          FMT_THROW(format_error("time_t value out of range"));
+        }
+        detail::seconds_to_tm(day * seconds_per_day, tm);
+        day_text.clear();
+        fields.clear();
+        auto w = detail::timestamp_writer(day_text, tm, fields);
+        detail::parse_chrono_format(format_str.begin(), format_str.end(), w);
+      }
+      auto size = buf.size();
+      buf.append(day_text.begin(), day_text.end());
+      for (auto field : fields)
+        detail::write_time_field(buf.data() + size, field, secs[i]);
+      buf.append(sep.begin(), sep.end());
+    }
+  }
+}
+
 FMT_MODULE_EXPORT_END
 FMT_END_NAMESPACE
 
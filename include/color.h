@@ -236,13 +236,132 @@ struct color_type {
 
 FMT_END_DETAIL_NAMESPACE
 
+FMT_BEGIN_DETAIL_NAMESPACE
+
+template <typename Char> struct ansi_color_escape {
+  FMT_CONSTEXPR ansi_color_escape(detail::color_type text_color,
+                                  const char* esc) FMT_NOEXCEPT : buffer() {
+    // If we have a terminal color, we need to output another escape code
+    // sequence.
+    if (!text_color.is_rgb) {
+      bool is_background = esc[2] == '4';
+      uint32_t value = text_color.value.term_color;
+      // Background ASCII codes are the same as the foreground ones but with
+      // 10 more.
+      if (is_background) value += 10u;
+
+      size_t index = 0;
+      buffer[index++] = static_cast<Char>('\x1b');
+      buffer[index++] = static_cast<Char>('[');
+
+      if (value >= 100u) {
+        buffer[index++] = static_cast<Char>('1');
+        value %= 100u;
+      }
+      buffer[index++] = static_cast<Char>('0' + value / 10u);
+      buffer[index++] = static_cast<Char>('0' + value % 10u);
+
+      buffer[index++] = static_cast<Char>('m');
+      size = index;
+      buffer[index++] = static_cast<Char>('\0');
+      return;
+    }
+
+    for (int i = 0; i < 7; i++) {
+      buffer[i] = static_cast<Char>(esc[i]);
+    }
+    rgb color(text_color.value.rgb_color);
+    to_esc(color.r, buffer + 7, ';');
+    to_esc(color.g, buffer + 11, ';');
+    to_esc(color.b, buffer + 15, 'm');
+    size = 19;
+    buffer[19] = static_cast<Char>(0);
+  }
+  FMT_CONSTEXPR ansi_color_escape(emphasis em) FMT_NOEXCEPT : buffer() {
+    uint8_t em_codes[num_emphases] = {};
+    if (has_emphasis(em, emphasis::bold)) em_codes[0] = 1;
+    if (has_emphasis(em, emphasis::faint)) em_codes[1] = 2;
+    if (has_emphasis(em, emphasis::italic)) em_codes[2] = 3;
+    if (has_emphasis(em, emphasis::underline)) em_codes[3] = 4;
+    if (has_emphasis(em, emphasis::blink)) em_codes[4] = 5;
+    if (has_emphasis(em, emphasis::reverse)) em_codes[5] = 7;
+    if (has_emphasis(em, emphasis::conceal)) em_codes[6] = 8;
+    if (has_emphasis(em, emphasis::strikethrough)) em_codes[7] = 9;
+
+    size_t index = 0;
+    for (size_t i = 0; i < num_emphases; ++i) {
+      if (!em_codes[i]) continue;
+      buffer[index++] = static_cast<Char>('\x1b');
+      buffer[index++] = static_cast<Char>('[');
+      buffer[index++] = static_cast<Char>('0' + em_codes[i]);
+      buffer[index++] = static_cast<Char>('m');
+    }
+    size = index;
+    buffer[index++] = static_cast<Char>(0);
+  }
+  FMT_CONSTEXPR operator const Char*() const FMT_NOEXCEPT { return buffer; }
+
+  FMT_CONSTEXPR const Char* begin() const FMT_NOEXCEPT { return buffer; }
+  FMT_CONSTEXPR const Char* end() const FMT_NOEXCEPT { return buffer + size; }
+
+  static constexpr size_t num_emphases = 8;
+  // The maximum size of an escape sequence for emphases or a color.
+  static constexpr size_t max_size = 4u * num_emphases;
+
+ private:
+  Char buffer[max_size + 1u];
+  size_t size = 0;
+
+  static FMT_CONSTEXPR void to_esc(uint8_t c, Char* out,
+                                   char delimiter) FMT_NOEXCEPT {
+    out[0] = static_cast<Char>('0' + c / 100);
+    out[1] = static_cast<Char>('0' + c / 10 % 10);
+    out[2] = static_cast<Char>('0' + c % 10);
+    out[3] = static_cast<Char>(delimiter);
+  }
+  static FMT_CONSTEXPR bool has_emphasis(emphasis em,
+                                         emphasis mask) FMT_NOEXCEPT {
+    return static_cast<uint8_t>(em) & static_cast<uint8_t>(mask);
+  }
+};
+
+template <typename Char>
+FMT_CONSTEXPR ansi_color_escape<Char> make_foreground_color(
+    detail::color_type foreground) FMT_NOEXCEPT {
+  return ansi_color_escape<Char>(foreground, "\x1b[38;2;");
+}
+
+template <typename Char>
+FMT_CONSTEXPR ansi_color_escape<Char> make_background_color(
+    detail::color_type background) FMT_NOEXCEPT {
+  return ansi_color_escape<Char>(background, "\x1b[48;2;");
+}
+
+template <typename Char>
+FMT_CONSTEXPR ansi_color_escape<Char> make_emphasis(emphasis em) FMT_NOEXCEPT {
+  return ansi_color_escape<Char>(em);
+}
+
+FMT_END_DETAIL_NAMESPACE
+
+class text_style;
+
+FMT_BEGIN_DETAIL_NAMESPACE
+FMT_CONSTEXPR basic_string_view<char> get_escape(const text_style& ts)
+    FMT_NOEXCEPT;
+FMT_END_DETAIL_NAMESPACE
+
 /** A text style consisting of foreground and background colors and emphasis. */
 class text_style {
  public:
   FMT_CONSTEXPR text_style(emphasis em = emphasis()) FMT_NOEXCEPT
       : set_foreground_color(),
         set_background_color(),
-        ems(em) {}
+        ems(em),
+        escape_(),
+        escape_size_() {
+    update_escape();
+  }
 
   FMT_CONSTEXPR text_style& operator|=(const text_style& rhs) {
     if (!set_foreground_color) {
@@ -265,6 +384,7 @@ class text_style {
 
     ems = static_cast<emphasis>(static_cast<uint8_t>(ems) |
                                 static_cast<uint8_t>(rhs.ems));
+    update_escape();
     return *this;
   }
 
@@ -310,7 +430,9 @@ class text_style {
                            detail::color_type text_color) FMT_NOEXCEPT
       : set_foreground_color(),
         set_background_color(),
-        ems() {
+        ems(),
+        escape_(),
+        escape_size_() {
     if (is_foreground) {
       foreground_color = text_color;
       set_foreground_color = true;
@@ -318,6 +440,24 @@ class text_style {
       background_color = text_color;
       set_background_color = true;
     }
+    update_escape();
+  }
+
+  FMT_CONSTEXPR void append_escape(const detail::ansi_color_escape<char>& esc)
+      FMT_NOEXCEPT {
+    for (auto p = esc.begin(); p != esc.end(); ++p)
+      escape_[escape_size_++] = *p;
+  }
+
+  // Computes the escape sequence once so that it is only copied when the style
+  // is used.
+  FMT_CONSTEXPR void update_escape() FMT_NOEXCEPT {
+    escape_size_ = 0;
+    if (has_emphasis()) append_escape(detail::make_emphasis<char>(ems));
+    if (set_foreground_color)
+      append_escape(detail::make_foreground_color<char>(foreground_color));
+    if (set_background_color)
+      append_escape(detail::make_background_color<char>(background_color));
   }
 
   // DEPRECATED!
@@ -342,6 +482,7 @@ class text_style {
 
     ems = static_cast<emphasis>(static_cast<uint8_t>(ems) &
                                 static_cast<uint8_t>(rhs.ems));
+    update_escape();
     return *this;
   }
 
@@ -351,13 +492,28 @@ class text_style {
   friend FMT_CONSTEXPR_DECL text_style bg(detail::color_type background)
       FMT_NOEXCEPT;
 
+  friend FMT_CONSTEXPR_DECL basic_string_view<char> detail::get_escape(
+      const text_style& ts) FMT_NOEXCEPT;
+
   detail::color_type foreground_color;
   detail::color_type background_color;
   bool set_foreground_color;
   bool set_background_color;
   emphasis ems;
+  // The ANSI escape sequence that sets the emphases and both colors.
+  char escape_[3 * detail::ansi_color_escape<char>::max_size];
+  size_t escape_size_;
 };
 
+FMT_BEGIN_DETAIL_NAMESPACE
+// Returns the escape sequence that sets the style or an empty string if the
+// style is empty.
+FMT_CONSTEXPR inline basic_string_view<char> get_escape(const text_style& ts)
+    FMT_NOEXCEPT {
+  return {ts.escape_, ts.escape_size_};
+}
+FMT_END_DETAIL_NAMESPACE
+
 /** Creates a text style from the foreground (text) color. */
 FMT_CONSTEXPR inline text_style fg(detail::color_type foreground) FMT_NOEXCEPT {
   return text_style(true, foreground);
@@ -375,105 +531,6 @@ FMT_CONSTEXPR inline text_style operator|(emphasis lhs,
 
 FMT_BEGIN_DETAIL_NAMESPACE
 
-template <typename Char> struct ansi_color_escape {
-  FMT_CONSTEXPR ansi_color_escape(detail::color_type text_color,
-                                  const char* esc) FMT_NOEXCEPT {
-    // If we have a terminal color, we need to output another escape code
-    // sequence.
-    if (!text_color.is_rgb) {
-      bool is_background = esc == string_view("\x1b[48;2;");
-      uint32_t value = text_color.value.term_color;
-      // Background ASCII codes are the same as the foreground ones but with
-      // 10 more.
-      if (is_background) value += 10u;
-
-      size_t index = 0;
-      buffer[index++] = static_cast<Char>('\x1b');
-      buffer[index++] = static_cast<Char>('[');
-
-      if (value >= 100u) {
-        buffer[index++] = static_cast<Char>('1');
-        value %= 100u;
-      }
-      buffer[index++] = static_cast<Char>('0' + value / 10u);
-      buffer[index++] = static_cast<Char>('0' + value % 10u);
-
-      buffer[index++] = static_cast<Char>('m');
-      buffer[index++] = static_cast<Char>('\0');
-      return;
-    }
-
-    for (int i = 0; i < 7; i++) {
-      buffer[i] = static_cast<Char>(esc[i]);
-    }
-    rgb color(text_color.value.rgb_color);
-    to_esc(color.r, buffer + 7, ';');
-    to_esc(color.g, buffer + 11, ';');
-    to_esc(color.b, buffer + 15, 'm');
-    buffer[19] = static_cast<Char>(0);
-  }
-  FMT_CONSTEXPR ansi_color_escape(emphasis em) FMT_NOEXCEPT {
-    uint8_t em_codes[num_emphases] = {};
-    if (has_emphasis(em, emphasis::bold)) em_codes[0] = 1;
-    if (has_emphasis(em, emphasis::faint)) em_codes[1] = 2;
-    if (has_emphasis(em, emphasis::italic)) em_codes[2] = 3;
-    if (has_emphasis(em, emphasis::underline)) em_codes[3] = 4;
-    if (has_emphasis(em, emphasis::blink)) em_codes[4] = 5;
-    if (has_emphasis(em, emphasis::reverse)) em_codes[5] = 7;
-    if (has_emphasis(em, emphasis::conceal)) em_codes[6] = 8;
-    if (has_emphasis(em, emphasis::strikethrough)) em_codes[7] = 9;
-
-    size_t index = 0;
-    for (size_t i = 0; i < num_emphases; ++i) {
-      if (!em_codes[i]) continue;
-      buffer[index++] = static_cast<Char>('\x1b');
-      buffer[index++] = static_cast<Char>('[');
-      buffer[index++] = static_cast<Char>('0' + em_codes[i]);
-      buffer[index++] = static_cast<Char>('m');
-    }
-    buffer[index++] = static_cast<Char>(0);
-  }
-  FMT_CONSTEXPR operator const Char*() const FMT_NOEXCEPT { return buffer; }
-
-  FMT_CONSTEXPR const Char* begin() const FMT_NOEXCEPT { return buffer; }
-  FMT_CONSTEXPR_CHAR_TRAITS const Char* end() const FMT_NOEXCEPT {
-    return buffer + std::char_traits<Char>::length(buffer);
-  }
-
- private:
-  static constexpr size_t num_emphases = 8;
-  Char buffer[7u + 3u * num_emphases + 1u];
-
-  static FMT_CONSTEXPR void to_esc(uint8_t c, Char* out,
-                                   char delimiter) FMT_NOEXCEPT {
-    out[0] = static_cast<Char>('0' + c / 100);
-    out[1] = static_cast<Char>('0' + c / 10 % 10);
-    out[2] = static_cast<Char>('0' + c % 10);
-    out[3] = static_cast<Char>(delimiter);
-  }
-  static FMT_CONSTEXPR bool has_emphasis(emphasis em,
-                                         emphasis mask) FMT_NOEXCEPT {
-    return static_cast<uint8_t>(em) & static_cast<uint8_t>(mask);
-  }
-};
-
-template <typename Char>
-FMT_CONSTEXPR ansi_color_escape<Char> make_foreground_color(
-    detail::color_type foreground) FMT_NOEXCEPT {
-  return ansi_color_escape<Char>(foreground, "\x1b[38;2;");
-}
-
-template <typename Char>
-FMT_CONSTEXPR ansi_color_escape<Char> make_background_color(
-    detail::color_type background) FMT_NOEXCEPT {
-  return ansi_color_escape<Char>(background, "\x1b[48;2;");
-}
-
-template <typename Char>
-FMT_CONSTEXPR ansi_color_escape<Char> make_emphasis(emphasis em) FMT_NOEXCEPT {
-  return ansi_color_escape<Char>(em);
-}
-
 template <typename Char>
 inline void fputs(const Char* chars, FILE* stream) FMT_NOEXCEPT {
   std::fputs(chars, stream);
@@ -502,24 +559,102 @@ template <typename Char>
 void vformat_to(buffer<Char>& buf, const text_style& ts,
                 basic_string_view<Char> format_str,
                 basic_format_args<buffer_context<type_identity_t<Char>>> args) {
-  bool has_style = false;
-  if (ts.has_emphasis()) {
-    has_style = true;
-    auto emphasis = detail::make_emphasis<Char>(ts.get_emphasis());
-    buf.append(emphasis.begin(), emphasis.end());
-  }
-  if (ts.has_foreground()) {
-    has_style = true;
-    auto foreground = detail::make_foreground_color<Char>(ts.get_foreground());
-    buf.append(foreground.begin(), foreground.end());
+  auto escape = get_escape(ts);
+  buf.append(escape.begin(), escape.end());
+  detail::vformat_to(buf, format_str, args, {});
+  if (escape.size() != 0) detail::reset_color<Char>(buf);
+}
+
+// Writes the formatted output to f with a single call.
+inline void print(std::FILE* f, buffer<char>& buf) {
+  if (is_utf8()) return print(f, string_view(buf.data(), buf.size()));
+  std::fwrite(buf.data(), 1, buf.size(), f);
+}
+
+inline void print(std::FILE* f, buffer<wchar_t>& buf) {
+  buf.push_back(L'\0');
+  std::fputws(buf.data(), f);
+}
+
+// Appends an SGR parameter to a list of parameters separated by ';'.
+inline void append_sgr_code(buffer<char>& codes, unsigned code) {
+  if (codes.size() != 0) codes.push_back(';');
+  char digits[3];
+  auto end = format_decimal<char>(digits, code, count_digits(code)).end;
+  codes.append(digits, end);
+}
+
+inline void append_sgr_color(buffer<char>& codes, color_type color,
+                             bool background) {
+  if (!color.is_rgb) {
+    // Background codes are the same as the foreground ones plus 10.
+    return append_sgr_code(codes,
+                           color.value.term_color + (background ? 10u : 0u));
   }
-  if (ts.has_background()) {
-    has_style = true;
-    auto background = detail::make_background_color<Char>(ts.get_background());
-    buf.append(background.begin(), background.end());
+  rgb c(color.value.rgb_color);
+  append_sgr_code(codes, background ? 48 : 38);
+  append_sgr_code(codes, 2);
+  append_sgr_code(codes, c.r);
+  append_sgr_code(codes, c.g);
+  append_sgr_code(codes, c.b);
+}
+
+inline auto same_color(color_type lhs, color_type rhs) -> bool {
+  if (lhs.is_rgb != rhs.is_rgb) return false;
+  return lhs.is_rgb ? lhs.value.rgb_color == rhs.value.rgb_color
+                    : lhs.value.term_color == rhs.value.term_color;
+}
+
+// Appends the escape sequence that changes the terminal style from the style
+// from to the style to, touching only the attributes that differ.
+inline void write_style_change(buffer<char>& buf, const text_style& from,
+                               const text_style& to) {
+  auto codes = basic_memory_buffer<char, 64>();
+  auto to_empty = get_escape(to).size() == 0;
+  if (to_empty) {
+    if (get_escape(from).size() != 0) append_sgr_code(codes, 0);
+  } else {
+    auto from_ems = from.has_emphasis()
+                        ? static_cast<unsigned>(from.get_emphasis())
+                        : 0u;
+    auto to_ems =
+        to.has_emphasis() ? static_cast<unsigned>(to.get_emphasis()) : 0u;
+    // SGR codes that turn the emphases on and off in the bit order of
+    // emphasis. 22 turns off both bold and faint.
+    const unsigned char on_codes[] = {1, 2, 3, 4, 5, 7, 8, 9};
+    const unsigned char off_codes[] = {22, 22, 23, 24, 25, 27, 28, 29};
+    auto removed = from_ems & ~to_ems;
+    auto added = to_ems & ~from_ems;
+    const unsigned bold_or_faint = 3;
+    if ((removed & bold_or_faint) != 0) {
+      append_sgr_code(codes, 22);
+      removed &= ~bold_or_faint;
+      added |= to_ems & bold_or_faint;
+    }
+    for (int i = 0; i < 8; ++i) {
+      if ((removed >> i) & 1) append_sgr_code(codes, off_codes[i]);
+    }
+    for (int i = 0; i < 8; ++i) {
+      if ((added >> i) & 1) append_sgr_code(codes, on_codes[i]);
+    }
+    if (!to.has_foreground()) {
+      if (from.has_foreground()) append_sgr_code(codes, 39);
+    } else if (!from.has_foreground() ||
+               !same_color(from.get_foreground(), to.get_foreground())) {
+      append_sgr_color(codes, to.get_foreground(), false);
+    }
+    if (!to.has_background()) {
+      if (from.has_background()) append_sgr_code(codes, 49);
+    } else if (!from.has_background() ||
+               !same_color(from.get_background(), to.get_background())) {
+      append_sgr_color(codes, to.get_background(), true);
+    }
   }
-  detail::vformat_to(buf, format_str, args, {});
-  if (has_style) detail::reset_color<Char>(buf);
+  if (codes.size() == 0) return;
+  buf.push_back('\x1b');
+  buf.push_back('[');
+  buf.append(codes.begin(), codes.end());
+  buf.push_back('m');
 }
 
 FMT_END_DETAIL_NAMESPACE
@@ -529,8 +664,25 @@ void vprint(std::FILE* f, const text_style& ts, const S& format,
             basic_format_args<buffer_context<type_identity_t<Char>>> args) {
   basic_memory_buffer<Char> buf;
   detail::vformat_to(buf, ts, to_string_view(format), args);
-  buf.push_back(Char(0));
-  detail::fputs(buf.data(), f);
+  detail::print(f, buf);
+}
+
+/**
+  \rst
+  Returns *ts* if *f* refers to a terminal and an empty style otherwise, so that
+  output that is redirected to a file or a pipe has no escape sequences. Styled
+  output with an empty style costs the same as unstyled output, so the check
+  can be done once and the result reused.
+
+  **Example**::
+
+    static const auto error_style =
+        fmt::terminal_style(stderr, fg(fmt::color::red));
+    fmt::print(stderr, error_style, "error: {}\n", message);
+  \endrst
+ */
+inline auto terminal_style(std::FILE* f, const text_style& ts) -> text_style {
+  return detail::is_terminal(f) ? ts : text_style();
 }
 
 /**
@@ -632,6 +784,55 @@ inline auto format_to(OutputIt out, const text_style& ts, const S& format_str,
                     fmt::make_args_checked<Args...>(format_str, args...));
 }
 
+/**
+  \rst
+  A buffer of styled text for redrawing large parts of a terminal. It tracks
+  the style the terminal is in and only writes the escape sequences for the
+  attributes that change between adjacent fragments instead of a full style
+  and a reset for every fragment. The output is written with a single call by
+  `flush`.
+
+  **Example**::
+
+    auto out = fmt::styled_buffer();
+    out.print(fg(fmt::color::green), "{:>8}", "ok");
+    out.print(fg(fmt::color::green) | fmt::emphasis::bold, " {}", 42);
+    out.print({}, " items\n");
+    out.flush();
+  \endrst
+ */
+class styled_buffer {
+ private:
+  basic_memory_buffer<char> buf_;
+  // The style that the output ends with.
+  text_style style_;
+
+ public:
+  /** Formats ``args`` and appends the output in the style ``ts``. */
+  template <typename... T>
+  void print(const text_style& ts, format_string<T...> fmt, T&&... args) {
+    detail::write_style_change(buf_, style_, ts);
+    style_ = ts;
+    detail::vformat_to(buf_, string_view(fmt), fmt::make_format_args(args...));
+  }
+
+  /** Appends a reset to the default style unless the output is in it. */
+  void reset() {
+    detail::write_style_change(buf_, style_, text_style());
+    style_ = text_style();
+  }
+
+  auto data() const -> const char* { return buf_.data(); }
+  auto size() const -> size_t { return buf_.size(); }
+
+  /** Resets the style and writes the output to ``f`` emptying the buffer. */
+  void flush(std::FILE* f = stdout) {
+    reset();
+    detail::print(f, buf_);
+    buf_.clear();
+  }
+};
+
 FMT_MODULE_EXPORT_END
 FMT_END_NAMESPACE
 
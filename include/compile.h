@@ -317,6 +317,72 @@ template <typename Char, typename T, int N> struct spec_field {
 template <typename Char, typename T, int N>
 struct is_compiled_format<spec_field<Char, T, N>> : std::true_type {};
 
+// A replacement field that refers to integer argument N with specifiers known
+// at compile time. Unlike spec_field it doesn't re-check alignment, sign,
+// alternate form and padding for each value: only the steps that apply to the
+// given specifiers are instantiated.
+template <typename Char, typename T, int N, presentation_type Type,
+          sign_t Sign, bool Alt, int Width, bool ZeroPad>
+struct int_spec_field {
+  using char_type = Char;
+
+  static constexpr unsigned base_bits =
+      Type == presentation_type::hex_lower ||
+              Type == presentation_type::hex_upper
+          ? 4
+          : Type == presentation_type::oct
+                ? 3
+                : Type == presentation_type::bin_lower ||
+                          Type == presentation_type::bin_upper
+                      ? 1
+                      : 0;
+  static constexpr bool upper = Type == presentation_type::hex_upper ||
+                                Type == presentation_type::bin_upper;
+
+  template <typename OutputIt, typename... Args>
+  constexpr OutputIt format(OutputIt out, const Args&... args) const {
+    auto arg = make_write_int_arg(get_arg_checked<T, N>(args...), Sign);
+    auto abs_value = arg.abs_value;
+    auto prefix = arg.prefix;
+    int num_digits = 0;
+    if constexpr (base_bits == 0) {
+      num_digits = count_digits(abs_value);
+    } else {
+      num_digits = count_digits<base_bits>(abs_value);
+      if constexpr (Alt && base_bits == 3) {
+        if (abs_value != 0) prefix_append(prefix, '0');
+      } else if constexpr (Alt) {
+        constexpr unsigned alt_char = base_bits == 4 ? 'x' : 'b';
+        prefix_append(prefix, (upper ? alt_char - 'a' + 'A' : alt_char) << 8 |
+                                  '0');
+      }
+    }
+    auto size = (prefix >> 24) + to_unsigned(num_digits);
+    size_t padding = 0;
+    if constexpr (Width != 0) {
+      if (to_unsigned(Width) > size) padding = to_unsigned(Width) - size;
+    }
+    auto it = reserve(out, size + padding);
+    if constexpr (Width != 0 && !ZeroPad)
+      it = detail::fill_n(it, padding, static_cast<Char>(' '));
+    for (unsigned p = prefix & 0xffffff; p != 0; p >>= 8)
+      *it++ = static_cast<Char>(p & 0xff);
+    if constexpr (Width != 0 && ZeroPad)
+      it = detail::fill_n(it, padding, static_cast<Char>('0'));
+    if constexpr (base_bits == 0)
+      it = format_decimal<Char>(it, abs_value, num_digits).end;
+    else
+      it = format_uint<base_bits, Char>(it, abs_value, num_digits, upper);
+    return base_iterator(out, it);
+  }
+};
+
+template <typename Char, typename T, int N, presentation_type Type,
+          sign_t Sign, bool Alt, int Width, bool ZeroPad>
+struct is_compiled_format<
+    int_spec_field<Char, T, N, Type, Sign, Alt, Width, ZeroPad>>
+    : std::true_type {};
+
 template <typename L, typename R> struct concat {
   L lhs;
   R rhs;
@@ -384,6 +450,42 @@ constexpr parse_specs_result<T, Char> parse_specs(basic_string_view<Char> str,
           next_arg_id == 0 ? manual_indexing_id : ctx.next_arg_id()};
 }
 
+template <typename Char> struct parse_int_specs_result {
+  dynamic_format_specs<Char> specs;
+  size_t end;
+  int next_arg_id;
+};
+
+// Parses specifiers of an integer replacement field the same way as
+// formatter<T, Char>::parse but keeps them accessible for compile-time
+// dispatch to int_spec_field.
+template <typename T, typename Char>
+constexpr parse_int_specs_result<Char> parse_int_specs(
+    basic_string_view<Char> str, size_t pos, int next_arg_id) {
+  str.remove_prefix(pos);
+  auto ctx = basic_format_parse_context<Char>(str, {}, next_arg_id);
+  auto specs = dynamic_format_specs<Char>();
+  using handler_type = dynamic_specs_handler<basic_format_parse_context<Char>>;
+  auto checker = specs_checker<handler_type>(
+      handler_type(specs, ctx),
+      mapped_type_constant<T, buffer_context<Char>>::value);
+  auto end = parse_format_specs(str.data(), str.data() + str.size(), checker);
+  check_int_type_spec(specs.type, ctx.error_handler());
+  return {specs, pos + fmt::detail::to_unsigned(end - str.data()) + 1,
+          next_arg_id == 0 ? manual_indexing_id : ctx.next_arg_id()};
+}
+
+// Returns true if integer specifiers can be handled by int_spec_field: width
+// is static, the type is a plain base and padding is either the default right
+// alignment with spaces or numeric zero padding.
+template <typename Char>
+constexpr bool is_static_int_specs(const dynamic_format_specs<Char>& specs) {
+  return specs.width_ref.kind == arg_id_kind::none &&
+         specs.precision_ref.kind == arg_id_kind::none && !specs.localized &&
+         specs.type != presentation_type::chr &&
+         (specs.align == align::none || specs.align == align::numeric);
+}
+
 template <typename Char> struct arg_id_handler {
   arg_ref<Char> arg_id;
 
@@ -426,6 +528,15 @@ struct field_type<T, enable_if_t<detail::is_named_arg<T>::value>> {
   using type = remove_cvref_t<decltype(T::value)>;
 };
 
+template <typename T, typename Args, size_t POS, int ARG_INDEX, int NEXT_ID,
+          typename S>
+constexpr auto parse_spec_field_then_tail(S format_str) {
+  constexpr auto str = basic_string_view<typename S::char_type>(format_str);
+  constexpr auto result = parse_specs<T>(str, POS, NEXT_ID);
+  return parse_tail<Args, result.end, result.next_arg_id>(
+      spec_field<typename S::char_type, T, ARG_INDEX>{result.fmt}, format_str);
+}
+
 template <typename T, typename Args, size_t END_POS, int ARG_INDEX, int NEXT_ID,
           typename S>
 constexpr auto parse_replacement_field_then_tail(S format_str) {
@@ -437,12 +548,29 @@ constexpr auto parse_replacement_field_then_tail(S format_str) {
         field<char_type, typename field_type<T>::type, ARG_INDEX>(),
         format_str);
   } else if constexpr (c == ':') {
-    constexpr auto result = parse_specs<typename field_type<T>::type>(
-        str, END_POS + 1, NEXT_ID == manual_indexing_id ? 0 : NEXT_ID);
-    return parse_tail<Args, result.end, result.next_arg_id>(
-        spec_field<char_type, typename field_type<T>::type, ARG_INDEX>{
-            result.fmt},
-        format_str);
+    using value_type = typename field_type<T>::type;
+    constexpr int next_arg_id = NEXT_ID == manual_indexing_id ? 0 : NEXT_ID;
+    if constexpr (is_integer<value_type>::value) {
+      constexpr auto result =
+          parse_int_specs<value_type>(str, END_POS + 1, next_arg_id);
+      if constexpr (is_static_int_specs(result.specs)) {
+        constexpr auto type = result.specs.type == presentation_type::none
+                                  ? presentation_type::dec
+                                  : result.specs.type;
+        return parse_tail<Args, result.end, result.next_arg_id>(
+            int_spec_field<char_type, value_type, ARG_INDEX, type,
+                           result.specs.sign, result.specs.alt,
+                           result.specs.width,
+                           result.specs.align == align::numeric>(),
+            format_str);
+      } else {
+        return parse_spec_field_then_tail<value_type, Args, END_POS + 1,
+                                          ARG_INDEX, next_arg_id>(format_str);
+      }
+    } else {
+      return parse_spec_field_then_tail<value_type, Args, END_POS + 1,
+                                        ARG_INDEX, next_arg_id>(format_str);
+    }
   }
 }
 
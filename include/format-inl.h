@@ -28,6 +28,10 @@
 
 #include "format.h"
 
+#if !defined(_WIN32) && FMT_HAS_INCLUDE(<unistd.h>)
+#  include <unistd.h>  // isatty
+#endif
+
 FMT_BEGIN_NAMESPACE
 namespace detail {
 
@@ -277,7 +281,30 @@ struct fp {
     return is_predecessor_closer;
   }
 
-  template <typename Float, FMT_ENABLE_IF(!is_supported<Float>::value)>
+  // Assigns a wider floating-point number with at most 64 significand bits
+  // such as x87 80-bit long double.
+  template <typename Float,
+            FMT_ENABLE_IF(!is_supported<Float>::value &&
+                          is_fp_compatible<Float>::value)>
+  bool assign(Float n) {
+    const int digits = std::numeric_limits<Float>::digits;
+    const int min_exp = std::numeric_limits<Float>::min_exponent;
+    int exp = 0;
+    // n = m * pow(2, exp) where m is in [0.5, 1).
+    Float m = std::frexp(n, &exp);
+    f = static_cast<uint64_t>(std::ldexp(m, digits));
+    e = exp - digits;
+    if (exp < min_exp) {
+      // Subnormals have the same exponent as the smallest normalized number.
+      f >>= min_exp - exp;
+      e = min_exp - digits;
+    }
+    return f == 1ULL << (digits - 1) && exp > min_exp;
+  }
+
+  template <typename Float,
+            FMT_ENABLE_IF(!is_supported<Float>::value &&
+                          !is_fp_compatible<Float>::value)>
   bool assign(Float) {
     FMT_ASSERT(false, "");
     return false;
@@ -375,6 +402,8 @@ class bigint {
   // 0 being the least significant one.
   using bigit = uint32_t;
   using double_bigit = uint64_t;
+  // Enough for any double. Values of wider types such as x87 long double with
+  // large exponents need more bigits which are then allocated dynamically.
   enum { bigits_capacity = 32 };
   basic_memory_buffer<bigit, bigits_capacity> bigits_;
   int exp_;
@@ -445,9 +474,6 @@ class bigint {
  public:
   FMT_CONSTEXPR20 bigint() : exp_(0) {}
   explicit bigint(uint64_t n) { assign(n); }
-  FMT_CONSTEXPR20 ~bigint() {
-    FMT_ASSERT(bigits_.capacity() <= bigits_capacity, "");
-  }
 
   bigint(const bigint&) = delete;
   void operator=(const bigint&) = delete;
@@ -495,6 +521,17 @@ class bigint {
     return *this;
   }
 
+  FMT_CONSTEXPR20 bigint& operator+=(uint32_t value) {
+    FMT_ASSERT(exp_ == 0, "");
+    for (size_t i = 0, n = bigits_.size(); value != 0 && i < n; ++i) {
+      double_bigit sum = static_cast<double_bigit>(bigits_[i]) + value;
+      bigits_[i] = static_cast<bigit>(sum);
+      value = static_cast<bigit>(sum >> bigit_bits);
+    }
+    if (value != 0) bigits_.push_back(value);
+    return *this;
+  }
+
   friend FMT_CONSTEXPR20 int compare(const bigint& lhs, const bigint& rhs) {
     int num_lhs_bigits = lhs.num_bigits(), num_rhs_bigits = rhs.num_bigits();
     if (num_lhs_bigits != num_rhs_bigits)
@@ -2219,10 +2256,21 @@ small_divisor_case_label:
 }
 }  // namespace dragonbox
 
+namespace dragon {
+enum {
+  predecessor_closer = 1,  // The predecessor is closer than the successor.
+  fixup = 2,  // exp10 is an estimate that can be one greater than the actual
+              // decimal exponent and needs to be corrected.
+  fixed = 4,  // Fixed format: extend the digits instead of the exponent on
+              // carry and with fixup treat num_digits as the number of digits
+              // after the decimal point.
+};
+}
+
 // Formats a floating-point number using a variation of the Fixed-Precision
 // Positive Floating-Point Printout ((FPP)^2) algorithm by Steele & White:
 // https://fmt.dev/papers/p372-steele.pdf.
-FMT_CONSTEXPR20 inline void format_dragon(fp value, bool is_predecessor_closer,
+FMT_CONSTEXPR20 inline void format_dragon(fp value, unsigned flags,
                                           int num_digits, buffer<char>& buf,
                                           int& exp10) {
   bigint numerator;    // 2 * R in (FPP)^2.
@@ -2234,11 +2282,10 @@ FMT_CONSTEXPR20 inline void format_dragon(fp value, bool is_predecessor_closer,
   // Shift numerator and denominator by an extra bit or two (if lower boundary
   // is closer) to make lower and upper integers. This eliminates multiplication
   // by 2 during later computations.
-  int shift = is_predecessor_closer ? 2 : 1;
-  uint64_t significand = value.f << shift;
+  int shift = (flags & dragon::predecessor_closer) != 0 ? 2 : 1;
   if (value.e >= 0) {
-    numerator.assign(significand);
-    numerator <<= value.e;
+    numerator.assign(value.f);
+    numerator <<= value.e + shift;
     lower.assign(1);
     lower <<= value.e;
     if (shift != 1) {
@@ -2256,11 +2303,13 @@ FMT_CONSTEXPR20 inline void format_dragon(fp value, bool is_predecessor_closer,
       upper_store <<= 1;
       upper = &upper_store;
     }
-    numerator *= significand;
+    numerator *= value.f;
+    numerator <<= shift;
     denominator.assign(1);
     denominator <<= shift - value.e;
   } else {
-    numerator.assign(significand);
+    numerator.assign(value.f);
+    numerator <<= shift;
     denominator.assign_pow10(exp10);
     denominator <<= shift - value.e;
     lower.assign(1);
@@ -2269,6 +2318,35 @@ FMT_CONSTEXPR20 inline void format_dragon(fp value, bool is_predecessor_closer,
       upper = &upper_store;
     }
   }
+  if ((flags & dragon::fixup) != 0) {
+    // Scale the value by 10 if the first digit would be zero. In the shortest
+    // mode keep the estimate if the rounding interval reaches pow(10, exp10).
+    bool even = (value.f & 1) == 0;
+    bool too_small =
+        num_digits < 0
+            ? add_compare(numerator, upper ? *upper : lower, denominator) +
+                      even <=
+                  0
+            : compare(numerator, denominator) < 0;
+    if (too_small) {
+      --exp10;
+      numerator *= 10;
+      if (num_digits < 0) {
+        lower *= 10;
+        if (upper) *upper *= 10;
+      }
+    }
+    if ((flags & dragon::fixed) != 0) {
+      int precision = num_digits;
+      num_digits += exp10 + 1;
+      if (num_digits < 0) {
+        // The value is less than half of the last digit's unit.
+        buf.push_back('0');
+        exp10 = -precision;
+        return;
+      }
+    }
+  }
   // Invariant: value == (numerator / denominator) * pow(10, exp10).
   if (num_digits < 0) {
     // Generate the shortest representation.
@@ -2327,7 +2405,10 @@ FMT_CONSTEXPR20 inline void format_dragon(fp value, bool is_predecessor_closer,
       }
       if (buf[0] == overflow) {
         buf[0] = '1';
-        ++exp10;
+        if ((flags & dragon::fixed) != 0)
+          buf.push_back('0');
+        else
+          ++exp10;
       }
       return;
     }
@@ -2336,6 +2417,117 @@ FMT_CONSTEXPR20 inline void format_dragon(fp value, bool is_predecessor_closer,
   buf[num_digits - 1] = static_cast<char>('0' + digit);
 }
 
+// Returns the maximum number of significant decimal digits of a Float value
+// which is reached by the largest subnormal, 767 for double.
+template <typename Float> constexpr int max_significant_digits() {
+  return (std::numeric_limits<Float>::digits -
+          std::numeric_limits<Float>::min_exponent) *
+             69897 / 100000 +
+         std::numeric_limits<Float>::digits10 + 2;
+}
+
+#if FMT_USE_EXACT_FIXED_PRECISION && FMT_USE_INT128
+// Returns pow(10, n) for n in [0, 38].
+inline uint128_t pow10_128(int n) {
+  FMT_ASSERT(n >= 0 && n <= 38, "invalid exponent");
+  if (n < 20) return impl_data::power_of_10_64[n];
+  return static_cast<uint128_t>(impl_data::power_of_10_64[19]) *
+         impl_data::power_of_10_64[n - 19];
+}
+
+// Computes round(value * pow(10, dec_exp)) with round half to even tie
+// breaking. value = significand * pow(2, bin_exp). Returns false if the
+// intermediate numerator or denominator doesn't fit in 127 bits.
+inline bool scale_and_round(uint64_t significand, int bin_exp, int dec_exp,
+                            uint128_t& result) {
+  const int max_bits = 127;
+  int significand_bits = num_bits<uint64_t>() - FMT_BUILTIN_CLZLL(significand);
+  auto numerator = static_cast<uint128_t>(significand);
+  int numerator_bits = significand_bits;
+  if (bin_exp > 0) {
+    numerator_bits += bin_exp;
+    if (numerator_bits > max_bits) return false;
+    numerator <<= bin_exp;
+  }
+  if (dec_exp > 0) {
+    if (dec_exp > 38) return false;
+    numerator_bits += dragonbox::floor_log2_pow10(dec_exp) + 1;
+    if (numerator_bits > max_bits) return false;
+    numerator *= pow10_128(dec_exp);
+  }
+  int shift = bin_exp < 0 ? -bin_exp : 0;
+  if (dec_exp >= 0) {
+    // The denominator is a power of 2 so division is a shift.
+    if (shift == 0) {
+      result = numerator;
+      return true;
+    }
+    if (shift > max_bits) {
+      // numerator < pow(2, shift - 1) so the value rounds down to zero.
+      result = 0;
+      return true;
+    }
+    result = numerator >> shift;
+    auto remainder = numerator & ((static_cast<uint128_t>(1) << shift) - 1);
+    auto half = static_cast<uint128_t>(1) << (shift - 1);
+    if (remainder > half || (remainder == half && (result & 1) != 0)) ++result;
+    return true;
+  }
+  if (-dec_exp > 38) return false;
+  int denominator_bits = dragonbox::floor_log2_pow10(-dec_exp) + 1 + shift;
+  if (denominator_bits > max_bits - 1) return false;
+  auto denominator = pow10_128(-dec_exp) << shift;
+  result = numerator / denominator;
+  auto remainder = numerator % denominator;
+  remainder <<= 1;
+  if (remainder > denominator || (remainder == denominator && (result & 1) != 0))
+    ++result;
+  return true;
+}
+
+// Formats f with the given precision using exact integer arithmetic
+// writing the digits to buf and their decimal exponent to exp. Unlike
+// Grisu it never needs a bigint fallback. Returns false if the value is out
+// of the supported range.
+inline bool format_exact_precision(fp f, int precision, bool fixed,
+                                   buffer<char>& buf, int& exp) {
+  if (fixed) {
+    uint128_t digits = 0;
+    if (!scale_and_round(f.f, f.e, precision, digits)) return false;
+    int num_digits = count_digits(digits);
+    buf.try_resize(to_unsigned(num_digits));
+    format_decimal(buf.data(), digits, num_digits);
+    exp = -precision;
+    return true;
+  }
+  const int max_precision = 19;
+  if (precision <= 0 || precision > max_precision) return false;
+  // floor(log10(value)) is either k or k + 1.
+  int significand_bits = num_bits<uint64_t>() - FMT_BUILTIN_CLZLL(f.f);
+  int e = f.e + significand_bits - 1;
+  // Scaled values of larger magnitudes don't fit in 128 bits anyway.
+  if (e < -1000 || e > 1000) return false;
+  int k = dragonbox::floor_log10_pow2(e);
+  auto limit = static_cast<uint128_t>(impl_data::power_of_10_64[precision]);
+  uint128_t digits = 0;
+  if (!scale_and_round(f.f, f.e, precision - 1 - k, digits)) return false;
+  if (digits > limit) {
+    // The estimate of the decimal exponent was too small.
+    ++k;
+    if (!scale_and_round(f.f, f.e, precision - 1 - k, digits)) return false;
+  }
+  exp = k - precision + 1;
+  if (digits == limit) {
+    // Rounding produced an extra digit.
+    digits /= 10;
+    ++exp;
+  }
+  buf.try_resize(to_unsigned(precision));
+  format_decimal(buf.data(), digits, precision);
+  return true;
+}
+#endif
+
 template <typename Float>
 FMT_HEADER_ONLY_CONSTEXPR20 int format_float(Float value, int precision,
                                              float_specs specs,
@@ -2357,7 +2549,10 @@ FMT_HEADER_ONLY_CONSTEXPR20 int format_float(Float value, int precision,
 
   if (specs.fallback) return snprintf_float(value, precision, specs, buf);
 
-  if (!is_constant_evaluated() && precision < 0) {
+  // Precision 0 in the general format gives one digit as in printf's %.0g.
+  if (!fixed && precision == 0) precision = 1;
+
+  if (!is_constant_evaluated() && precision < 0 && is_fast_float<Float>()) {
     // Use Dragonbox for the shortest format.
     if (specs.binary32) {
       auto dec = dragonbox::to_decimal(static_cast<float>(value));
@@ -2371,6 +2566,13 @@ FMT_HEADER_ONLY_CONSTEXPR20 int format_float(Float value, int precision,
 
   int exp = 0;
   bool use_dragon = true;
+  unsigned dragon_flags = fixed ? dragon::fixed : 0;
+#if FMT_USE_EXACT_FIXED_PRECISION && FMT_USE_INT128
+  if (!is_constant_evaluated() && precision >= 0 &&
+      format_exact_precision(fp(value), precision, fixed, buf, exp)) {
+    use_dragon = false;
+  } else
+#endif
   if (is_fast_float<Float>()) {
     // Use Grisu + Dragon4 for the given precision:
     // https://www.cs.tufts.edu/~nr/cs257/archive/florian-loitsch/printf.pdf.
@@ -2390,16 +2592,25 @@ FMT_HEADER_ONLY_CONSTEXPR20 int format_float(Float value, int precision,
       exp += handler.size - cached_exp10 - 1;
       precision = handler.precision;
     }
+  } else {
+    // Estimate the decimal exponent as floor(log10(pow(2, e + bits - 1))) + 1
+    // which is at most one greater than the actual one.
+    auto f = fp(value);
+    int e = f.e + num_bits<uint64_t>() - FMT_BUILTIN_CLZLL(f.f) - 1;
+    const auto log10_2 = static_cast<int64_t>(log10_2_significand >> 32);
+    exp = static_cast<int>((e * log10_2) >> 32) + 1;
+    dragon_flags |= dragon::fixup;
   }
   if (use_dragon) {
     auto f = fp();
     bool is_predecessor_closer =
         specs.binary32 ? f.assign(static_cast<float>(value)) : f.assign(value);
+    if (is_predecessor_closer) dragon_flags |= dragon::predecessor_closer;
     // Limit precision to the maximum possible number of significant digits in
-    // an IEEE754 double because we don't need to generate zeros.
-    const int max_double_digits = 767;
-    if (precision > max_double_digits) precision = max_double_digits;
-    format_dragon(f, is_predecessor_closer, precision, buf, exp);
+    // Float because we don't need to generate zeros.
+    const int max_digits = max_significant_digits<Float>();
+    if (precision > max_digits) precision = max_digits;
+    format_dragon(f, dragon_flags, precision, buf, exp);
   }
   if (!fixed && !specs.showpoint) {
     // Remove trailing zeros.
@@ -2516,6 +2727,228 @@ int snprintf_float(T value, int precision, float_specs specs,
     return exp - fraction_size;
   }
 }
+
+namespace parse {
+// The binary exponent of the maximum and minimum (subnormal) doubles.
+enum { max_binary_exp = 1023, min_binary_exp = -1074 };
+
+inline int count_leading_zeros(uint64_t n) {
+#ifdef FMT_BUILTIN_CLZLL
+  return FMT_BUILTIN_CLZLL(n);
+#else
+  int count = 0;
+  for (; (n & (1ULL << 63)) == 0; n <<= 1) ++count;
+  return count;
+#endif
+}
+
+// Converts significand * pow(10, exp10) to the bits of a correctly rounded
+// positive double using the Eisel-Lemire algorithm with the Dragonbox cache of
+// powers of 10. Returns false if the result cannot be determined from the
+// 128-bit approximation of pow(10, exp10) or is subnormal.
+inline bool eisel_lemire(uint64_t significand, int exp10,
+                         uint64_t& bits) FMT_NOEXCEPT {
+  const uint64_t infinity_bits = 0x7ffULL << 52;
+  if (exp10 > dragonbox::float_info<double>::max_k) {
+    bits = infinity_bits;
+    return true;
+  }
+  if (exp10 < dragonbox::float_info<double>::min_k) return false;
+  int lz = count_leading_zeros(significand);
+  uint64_t w = significand << lz;
+  // The cache entry differs from the exact pow(10, exp10) normalized to 128
+  // bits by less than 1 and is exact for exp10 in [0, 55].
+  auto pow10 = dragonbox::cache_accessor<double>::get_cached_power(exp10);
+  uint128_wrapper low = dragonbox::umul128(w, pow10.low());
+  uint128_wrapper high = dragonbox::umul128(w, pow10.high());
+  // Compute the 192-bit product hi:mid:lo.
+  uint64_t lo = low.low();
+  uint64_t mid = high.low() + low.high();
+  uint64_t hi = high.high() + (mid < low.high() ? 1 : 0);
+  int upper_bit = static_cast<int>(hi >> 63);
+  int shift = 10 + upper_bit;  // Keep 53 bits of the significand.
+  uint64_t mantissa = hi >> shift;
+  uint64_t tail = hi & ((1ULL << shift) - 1);
+  uint64_t half = 1ULL << (shift - 1);
+  int biased_exp = 63 + upper_bit + dragonbox::floor_log2_pow10(exp10) - lz +
+                   max_binary_exp;
+  if (biased_exp <= 0) return false;
+  bool round_up = false;
+  if (exp10 >= 0 && exp10 <= 55) {
+    round_up = tail > half ||
+               (tail == half && ((mid | lo) != 0 || (mantissa & 1) != 0));
+  } else {
+    // The error of the product is less than one unit of mid so the exact
+    // value is ambiguous only if hi:mid is within one unit of the midpoint.
+    if ((tail == half && mid == 0) ||
+        (tail == half - 1 && mid == max_value<uint64_t>()))
+      return false;
+    round_up = tail >= half;
+  }
+  if (round_up && ++mantissa == 1ULL << 53) {
+    mantissa >>= 1;
+    ++biased_exp;
+  }
+  if (biased_exp >= 0x7ff) {
+    bits = infinity_bits;
+    return true;
+  }
+  bits = (static_cast<uint64_t>(biased_exp) << 52) |
+         (mantissa & ((1ULL << 52) - 1));
+  return true;
+}
+
+// Computes a double m * pow(2, e2) that is less than or equal to
+// significand * pow(10, exp10) and at most a few ulps below it. Returns false
+// on overflow.
+inline bool estimate(uint64_t significand, int exp10, uint64_t& m,
+                     int& e2) FMT_NOEXCEPT {
+  int lz = count_leading_zeros(significand);
+  auto value = fp(significand << lz, -lz);
+  const int min_k = dragonbox::float_info<double>::min_k;
+  const int max_k = dragonbox::float_info<double>::max_k;
+  while (exp10 != 0) {
+    int k = exp10 < min_k ? min_k : exp10 > max_k ? max_k : exp10;
+    // Round the power of 10 down.
+    uint64_t pow10 =
+        dragonbox::cache_accessor<double>::get_cached_power(k).high() - 1;
+    uint128_wrapper product = dragonbox::umul128(value.f, pow10);
+    value.f = product.high();
+    value.e += dragonbox::floor_log2_pow10(k) + 1;
+    uint64_t low = product.low();
+    while ((value.f >> 63) == 0) {
+      value.f = (value.f << 1) | (low >> 63);
+      low <<= 1;
+      --value.e;
+    }
+    exp10 -= k;
+  }
+  int exp = value.e + 63;  // The exponent of the most significant bit.
+  if (exp > max_binary_exp) return false;
+  if (exp >= 1 - max_binary_exp) {
+    m = value.f >> 11;
+    e2 = exp - 52;
+    return true;
+  }
+  int shift = 11 + (1 - max_binary_exp - exp);
+  m = shift < 64 ? value.f >> shift : 0;
+  e2 = min_binary_exp;
+  return true;
+}
+
+inline void multiply_pow5(bigint& n, int exp) {
+  const uint64_t pow5_27 = 7450580596923828125ULL;
+  for (; exp >= 27; exp -= 27) n *= pow5_27;
+  uint64_t pow5 = 1;
+  for (; exp > 0; --exp) pow5 *= 5;
+  if (pow5 != 1) n *= pow5;
+}
+
+// Converts the decimal number with digits from [int_begin, int_end) and
+// [frac_begin, frac_end) multiplied by pow(10, exp10) to the bits of a
+// correctly rounded positive double using exact comparison of bigints.
+// approx_significand and approx_exp10 is a truncated approximation of the
+// number. Returns false on overflow or underflow.
+FMT_FUNC bool decimal_to_double(const char* int_begin, const char* int_end,
+                                const char* frac_begin, const char* frac_end,
+                                int exp10, uint64_t approx_significand,
+                                int approx_exp10, uint64_t& bits) {
+  // Digits after the first 780 significant ones can only break a tie between
+  // two doubles and are replaced by a single nonzero digit if needed.
+  const int max_digits = 780;
+  bigint digits;
+  int num_digits = 0;
+  bool nonzero_tail = false;
+  uint32_t chunk = 0, chunk_scale = 1;
+  const char* ranges[2][2] = {{int_begin, int_end}, {frac_begin, frac_end}};
+  for (int r = 0; r < 2; ++r) {
+    bool fraction = r == 1;
+    for (auto p = ranges[r][0]; p != ranges[r][1]; ++p) {
+      if (num_digits == 0 && *p == '0') {
+        if (fraction) --exp10;
+        continue;
+      }
+      if (num_digits == max_digits) {
+        if (*p != '0') nonzero_tail = true;
+        if (!fraction) ++exp10;
+        continue;
+      }
+      chunk = chunk * 10 + static_cast<uint32_t>(*p - '0');
+      chunk_scale *= 10;
+      if (fraction) --exp10;
+      if (num_digits++ == 0) {
+        digits.assign(chunk);
+        chunk = 0;
+        chunk_scale = 1;
+      } else if (chunk_scale == 1000000000) {
+        digits *= chunk_scale;
+        digits += chunk;
+        chunk = 0;
+        chunk_scale = 1;
+      }
+    }
+  }
+  if (chunk_scale != 1) {
+    digits *= chunk_scale;
+    digits += chunk;
+  }
+  if (nonzero_tail) {
+    digits *= 10u;
+    digits += 1u;
+    --exp10;
+    ++num_digits;
+  }
+  // The value is in [pow(10, exp10 + num_digits - 1), pow(10, exp10 +
+  // num_digits)).
+  if (exp10 + num_digits > 310) return false;
+  if (exp10 + num_digits < -323) return false;
+  uint64_t m = 0;
+  int e2 = 0;
+  if (!estimate(approx_significand, approx_exp10, m, e2)) return false;
+  if (exp10 >= 0) multiply_pow5(digits, exp10);
+  // Compare the value with the midpoint between m * pow(2, e2) and the next
+  // double which is (2 * m + 1) * pow(2, e2 - 1) and move up until it is
+  // greater than the value.
+  for (;;) {
+    bigint lhs, rhs(2 * m + 1);
+    lhs.assign(digits);
+    if (exp10 < 0) multiply_pow5(rhs, -exp10);
+    int shift = exp10 - (e2 - 1);
+    if (shift > 0)
+      lhs <<= shift;
+    else
+      rhs <<= -shift;
+    // Align the bigints because compare doesn't handle trailing zero bigits.
+    lhs.align(rhs);
+    rhs.align(lhs);
+    int cmp = compare(lhs, rhs);
+    if (cmp < 0) break;
+    if (cmp == 0 && (m & 1) == 0) break;
+    if (++m == 1ULL << 53) {
+      m >>= 1;
+      ++e2;
+    }
+    if (e2 > max_binary_exp - 52) return false;
+    if (cmp == 0) break;
+  }
+  if (m == 0) return false;
+  if (m < 1ULL << 52) {
+    bits = m;  // Subnormal.
+    return true;
+  }
+  bits = (static_cast<uint64_t>(e2 + 52 + max_binary_exp) << 52) |
+         (m & ((1ULL << 52) - 1));
+  return true;
+}
+
+// Checks if [begin, end) starts with a lowercase string str ignoring case.
+inline bool starts_with(const char* begin, const char* end, const char* str) {
+  for (; *str; ++begin, ++str) {
+    if (begin == end || (*begin | 0x20) != *str) return false;
+  }
+  return true;
+}
+}  // namespace parse
 }  // namespace detail
 
 template <> struct formatter<detail::bigint> {
@@ -2545,18 +2978,47 @@ template <> struct formatter<detail::bigint> {
 };
 
 FMT_FUNC detail::utf8_to_utf16::utf8_to_utf16(string_view s) {
-  for_each_codepoint(s, [this](uint32_t cp, string_view) {
-    if (cp == invalid_code_point) FMT_THROW(std::runtime_error("invalid utf8"));
-    if (cp <= 0xFFFF) {
-      buffer_.push_back(static_cast<wchar_t>(cp));
-    } else {
-      cp -= 0x10000;
-      buffer_.push_back(static_cast<wchar_t>(0xD800 + (cp >> 10)));
-      buffer_.push_back(static_cast<wchar_t>(0xDC00 + (cp & 0x3FF)));
-    }
-    return true;
-  });
-  buffer_.push_back(0);
+  // UTF-16 never needs more code units than UTF-8 so the buffer is sized once.
+  buffer_.resize(s.size() + 1);
+  wchar_t* out = buffer_.data();
+  auto p = s.data(), end = s.data() + s.size();
+  for (;;) {
+    // Widen runs of ASCII characters in bulk and decode only the rest.
+    auto non_ascii = find_non_ascii(p, end);
+    for (; p != non_ascii; ++p) *out++ = static_cast<wchar_t>(*p);
+    if (p == end) break;
+    p = end;
+    for_each_codepoint(
+        string_view(non_ascii, to_unsigned(end - non_ascii)),
+        [&](uint32_t cp, string_view sv) {
+          if ((static_cast<unsigned char>(*sv.data()) & 0x80) == 0) {
+            // Switch back to the bulk path at runs of ASCII characters.
+            auto next = sv.data() + 1;
+            if (next != end &&
+                (static_cast<unsigned char>(*next) & 0x80) == 0) {
+              p = sv.data();
+              return false;
+            }
+            *out++ = static_cast<wchar_t>(cp);
+            return true;
+          }
+          // A non-ASCII byte is never a complete code point on its own.
+          if (cp == invalid_code_point || sv.size() == 1) {
+            FMT_THROW(std::runtime_error(fmt::format(
+                "invalid utf8 at position {}", sv.data() - s.data())));
+          }
+          if (cp <= 0xFFFF) {
+            *out++ = static_cast<wchar_t>(cp);
+          } else {
+            cp -= 0x10000;
+            *out++ = static_cast<wchar_t>(0xD800 + (cp >> 10));
+            *out++ = static_cast<wchar_t>(0xDC00 + (cp & 0x3FF));
+          }
+          return true;
+        });
+  }
+  *out = 0;
+  buffer_.resize(to_unsigned(out - buffer_.data()) + 1);
 }
 
 FMT_FUNC void format_system_error(detail::buffer<char>& out, int error_code,
@@ -2583,6 +3045,110 @@ FMT_FUNC std::string vformat(string_view fmt, format_args args) {
   return to_string(buffer);
 }
 
+FMT_FUNC auto from_chars(const char* first, const char* last, double& value)
+    -> from_chars_result {
+  using detail::is_decimal_digit;
+  using detail::parse_decimal;
+  const int max_int = detail::max_value<int>();
+  auto p = first;
+  bool negative = p != last && *p == '-';
+  if (negative) ++p;
+  auto sign_bit = negative ? 1ULL << 63 : 0;
+  if (p != last && !is_decimal_digit(*p) && *p != '.') {
+    auto bits = 0x7ffULL << 52;
+    if (detail::parse::starts_with(p, last, "inf")) {
+      p += 3;
+      if (detail::parse::starts_with(p, last, "inity")) p += 5;
+    } else if (detail::parse::starts_with(p, last, "nan")) {
+      p += 3;
+      bits |= 1ULL << 51;
+      if (p != last && *p == '(') {
+        auto end = p + 1;
+        while (end != last && (is_decimal_digit(*end) || *end == '_' ||
+                               ((*end | 0x20) >= 'a' && (*end | 0x20) <= 'z')))
+          ++end;
+        if (end != last && *end == ')') p = end + 1;
+      }
+    } else {
+      return {first, std::errc::invalid_argument};
+    }
+    value = detail::bit_cast<double>(bits | sign_bit);
+    return {p, std::errc()};
+  }
+
+  // Parse digits accumulating the significand modulo pow(2, 64).
+  uint64_t significand = 0;
+  auto int_begin = p;
+  p = parse_decimal(p, last, max_int, significand);
+  auto int_end = p, frac_begin = p, frac_end = p;
+  if (p != last && *p == '.') {
+    frac_begin = ++p;
+    p = parse_decimal(p, last, max_int, significand);
+    frac_end = p;
+  }
+  if (int_begin == int_end && frac_begin == frac_end)
+    return {first, std::errc::invalid_argument};
+  int exp10 = 0;
+  if (p != last && (*p | 0x20) == 'e') {
+    auto exp_begin = p + 1;
+    bool negative_exp = exp_begin != last && *exp_begin == '-';
+    if (exp_begin != last && (*exp_begin == '-' || *exp_begin == '+'))
+      ++exp_begin;
+    if (exp_begin != last && is_decimal_digit(*exp_begin)) {
+      for (p = exp_begin; p != last && is_decimal_digit(*p); ++p) {
+        if (exp10 < 100000000) exp10 = exp10 * 10 + (*p - '0');
+      }
+      if (negative_exp) exp10 = -exp10;
+    }
+  }
+  int approx_exp10 = exp10 - static_cast<int>(frac_end - frac_begin);
+
+  // If there are more than 19 significant digits, reparse the first 19.
+  auto first_digit = int_begin;
+  while (first_digit != int_end && *first_digit == '0') ++first_digit;
+  bool truncated = false;
+  if (first_digit == int_end) {
+    first_digit = frac_begin;
+    while (first_digit != frac_end && *first_digit == '0') ++first_digit;
+    if (frac_end - first_digit > 19) {
+      truncated = true;
+      significand = 0;
+      auto end = parse_decimal(first_digit, frac_end, 19, significand);
+      approx_exp10 = exp10 - static_cast<int>(end - frac_begin);
+    }
+  } else if ((int_end - first_digit) + (frac_end - frac_begin) > 19) {
+    truncated = true;
+    significand = 0;
+    auto end = parse_decimal(first_digit, int_end, 19, significand);
+    if (end != int_end) {
+      approx_exp10 = exp10 + static_cast<int>(int_end - end);
+    } else {
+      auto num_int_digits = static_cast<int>(int_end - first_digit);
+      end = parse_decimal(frac_begin, frac_end, 19 - num_int_digits,
+                          significand);
+      approx_exp10 = exp10 - static_cast<int>(end - frac_begin);
+    }
+  }
+
+  uint64_t bits = 0;
+  if (significand != 0) {
+    uint64_t upper_bits = 0;
+    bool ok = detail::parse::eisel_lemire(significand, approx_exp10, bits);
+    // The exact value is between significand and significand + 1 scaled.
+    if (ok && truncated)
+      ok = detail::parse::eisel_lemire(significand + 1, approx_exp10,
+                                       upper_bits) &&
+           bits == upper_bits;
+    if (!ok && !detail::parse::decimal_to_double(
+                   int_begin, int_end, frac_begin, frac_end, exp10,
+                   significand, approx_exp10, bits))
+      return {p, std::errc::result_out_of_range};
+    if (bits == 0x7ffULL << 52) return {p, std::errc::result_out_of_range};
+  }
+  value = detail::bit_cast<double>(bits | sign_bit);
+  return {p, std::errc()};
+}
+
 #ifdef _WIN32
 namespace detail {
 using dword = conditional_t<sizeof(long) == 4, unsigned long, unsigned>;
@@ -2609,6 +3175,17 @@ FMT_FUNC void print(std::FILE* f, string_view text) {
 #endif
   detail::fwrite_fully(text.data(), 1, text.size(), f);
 }
+
+FMT_FUNC auto is_terminal(std::FILE* f) -> bool {
+#ifdef _WIN32
+  return _isatty(_fileno(f)) != 0;
+#elif FMT_HAS_INCLUDE(<unistd.h>)
+  return isatty(fileno(f)) != 0;
+#else
+  ignore_unused(f);
+  return true;
+#endif
+}
 }  // namespace detail
 
 FMT_FUNC void vprint(std::FILE* f, string_view format_str, format_args args) {
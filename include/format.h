@@ -465,6 +465,36 @@ FMT_CONSTEXPR20 auto fill_n(T* out, Size count, char value) -> T* {
   return out + count;
 }
 
+// Fills a buffer in chunks instead of one element at a time, stopping early if
+// the buffer discards the rest of the output.
+template <typename T, typename Size>
+FMT_CONSTEXPR20 void fill_buffer(buffer<T>& buf, Size count, const T& value) {
+  if (count <= 0) return;
+  size_t n = to_unsigned(count);
+  while (n != 0) {
+    buf.try_reserve(buf.size() + n);
+    auto size = buf.size();
+    auto free_cap = buf.capacity() - size;
+    if (free_cap == 0) return;  // The buffer discards the rest of the output.
+    auto chunk = free_cap < n ? free_cap : n;
+    buf.try_resize(size + chunk);
+    fill_n(buf.data() + size, chunk, value);
+    n -= chunk;
+  }
+}
+template <typename Size>
+FMT_CONSTEXPR20 auto fill_n(appender out, Size count, char value) -> appender {
+  fill_buffer(get_container(out), count, value);
+  return out;
+}
+template <typename T, typename Size>
+FMT_CONSTEXPR20 auto fill_n(std::back_insert_iterator<buffer<T>> out,
+                            Size count, const T& value)
+    -> std::back_insert_iterator<buffer<T>> {
+  fill_buffer(get_container(out), count, value);
+  return out;
+}
+
 #ifdef __cpp_char8_t
 using char8_type = char8_t;
 #else
@@ -561,6 +591,157 @@ FMT_CONSTEXPR void for_each_codepoint(string_view s, F f) {
   }
 }
 
+// Returns a pointer to the first non-ASCII character in [begin, end) checking
+// 8 characters at a time.
+FMT_CONSTEXPR inline auto find_non_ascii(const char* begin, const char* end)
+    -> const char* {
+  for (; !is_constant_evaluated() && end - begin >= 8; begin += 8) {
+    uint64_t chunk = 0;
+    std::memcpy(&chunk, begin, sizeof(chunk));
+    if ((chunk & 0x8080808080808080) != 0) break;
+  }
+  while (begin != end && (static_cast<unsigned char>(*begin) & 0x80) == 0)
+    ++begin;
+  return begin;
+}
+
+template <typename T = void> struct basic_width_data {
+  // Bitmaps of wide (East Asian Width W or F) code points split into blocks of
+  // 256 code points indexed by cp >> 8.
+  // These are generated by support/east-asian-width.py.
+  // Code points >= 0x40000 are not wide.
+  static constexpr uint8_t wide_index[1024] = {
+      0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+      0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+      0, 0, 0, 2, 0, 3, 4, 5, 0, 0, 0, 6, 0, 0, 7, 8,
+      9, 10, 11, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12,
+      12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 13, 12, 12,
+      12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12,
+      12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12,
+      12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12,
+      12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12,
+      12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12,
+      12, 12, 12, 12, 14, 0, 0, 0, 0, 15, 0, 0, 12, 12, 12, 12,
+      12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12,
+      12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12,
+      12, 12, 12, 12, 12, 12, 12, 16, 0, 0, 0, 0, 0, 0, 0, 0,
+      0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+      0, 0, 0, 0, 0, 0, 0, 0, 0, 12, 12, 0, 0, 0, 17, 18,
+      0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+      0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+      0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+      0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+      0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+      0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+      0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 19,
+      12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12,
+      12, 12, 12, 12, 12, 12, 12, 20, 12, 12, 12, 12, 21, 22, 0, 0,
+      0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+      0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 23,
+      12, 24, 25, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+      0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+      0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+      0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+      26, 27, 28, 29, 30, 31, 32, 33, 0, 34, 35, 0, 0, 0, 0, 0,
+      12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12,
+      12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12,
+      12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12,
+      12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12,
+      12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12,
+      12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12,
+      12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12,
+      12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12,
+      12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12,
+      12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12,
+      12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12,
+      12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12,
+      12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12,
+      12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12,
+      12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12,
+      12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 36,
+      12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12,
+      12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12,
+      12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12,
+      12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12,
+      12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12,
+      12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12,
+      12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12,
+      12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12,
+      12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12,
+      12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12,
+      12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12,
+      12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12,
+      12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12,
+      12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12,
+      12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12,
+      12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 36,
+  };
+  static constexpr uint64_t wide_blocks[148] = {
+      0x0000000000000000, 0x0000000000000000, 0x0000000000000000,
+      0x0000000000000000, 0xffffffffffffffff, 0x00000000ffffffff,
+      0x0000000000000000, 0x0000000000000000, 0x000006000c000000,
+      0x0000000000000000, 0x0000000000000000, 0x00091e0000000000,
+      0x0000000000000000, 0x0000000000000000, 0x0000000000000000,
+      0x6000000000000000, 0x0000000000300000, 0x80000000000fff00,
+      0x60000c0200080000, 0x242c040000104030, 0x0000010000000c20,
+      0x0000000000b85000, 0x8001000000e00000, 0x0000000000000000,
+      0x0000000018000000, 0x0000000000210000, 0x0000000000000000,
+      0x0000000000000000, 0x0000000000000000, 0x0000000000000000,
+      0xfffffffffbffffff, 0x000fffffffffffff, 0xffffffffffffffff,
+      0xffffffffffffffff, 0xffffffffffffffff, 0x0fff0000003fffff,
+      0x7fffffffffffffff, 0xfffffffffffffffe, 0xfffffffffe7fffff,
+      0xffffffffffffffff, 0xfffeffffffffffe0, 0xffffffffffffffff,
+      0xffffffffffff7fff, 0xffff000fffffffff, 0xffffffff7fffffff,
+      0xffffffffffff00ff, 0xffffffffffffffff, 0xffffffffffffffff,
+      0xffffffffffffffff, 0xffffffffffffffff, 0xffffffffffffffff,
+      0xffffffffffffffff, 0xffffffffffffffff, 0xffffffffffffffff,
+      0xffffffffffffffff, 0x0000000000000000, 0xffffffffffffffff,
+      0xffffffffffffffff, 0xffffffffffff1fff, 0x000000000000007f,
+      0x0000000000000000, 0x1fffffff00000000, 0x0000000000000000,
+      0x0000000000000000, 0xffffffffffffffff, 0xffffffffffffffff,
+      0x0000000fffffffff, 0x0000000000000000, 0xffff000003ff0000,
+      0x00000f7ffff7ffff, 0x0000000000000000, 0x0000000000000000,
+      0xfffffffffffffffe, 0x00000001ffffffff, 0x0000000000000000,
+      0x0000007f00000000, 0x0000000000000000, 0x0000000000000000,
+      0x0000000000000000, 0x0003001f00000000, 0xffffffffffffffff,
+      0xffffffffffffffff, 0xffffffffffffffff, 0x00ffffffffffffff,
+      0xffffffffffffffff, 0xffffffffffffffff, 0xffffffffffffffff,
+      0x00000000003fffff, 0x00000000000001ff, 0x0000000000000000,
+      0x0000000000000000, 0x0000000000000000, 0x0000000000000000,
+      0x0000000000000000, 0x0000000000000000, 0x6fef000000000000,
+      0x00000007ffffffff, 0xffff00f000070000, 0xffffffffffffffff,
+      0xffffffffffffffff, 0xffffffffffffffff, 0xffffffffffffffff,
+      0xffffffffffffffff, 0x0fffffffffffffff, 0x0000000000000010,
+      0x0000000000000000, 0x0000000000000000, 0x0000000000008000,
+      0x0000000000000000, 0x0000000000000000, 0x0000000007fe4000,
+      0x0000000000000000, 0x0fffffffffff0007, 0x0000003f000301ff,
+      0x0000000000000000, 0x0000000000000000, 0xffbfe001ffffffff,
+      0xdfffffffffffffff, 0xffffffff000fffff, 0xff11ffff000f87ff,
+      0x7fffffffffffffff, 0xfffffffffffffffd, 0xffffffffffffffff,
+      0x9fffffffffffffff, 0x3fffffffffffffff, 0x040000ffffff7800,
+      0x0000001000600000, 0xf800000000000000, 0xffffffffffffffff,
+      0x000000000000ffff, 0xffffffffffffffff, 0x1ff01800e0e7103f,
+      0x0000000000000000, 0x0000000000000000, 0x0000000000000000,
+      0x00010fff00000000, 0xf7fffffffffff000, 0xffffffffffffffbf,
+      0xffffffffffffffff, 0xffffffffffffffff, 0x0000000000000000,
+      0x1f1f000000000000, 0x07ff1fffffff007f, 0x007f00ff03ff003f,
+      0xffffffffffffffff, 0xffffffffffffffff, 0xffffffffffffffff,
+      0x3fffffffffffffff,
+  };
+};
+
+template <typename T> constexpr uint8_t basic_width_data<T>::wide_index[];
+template <typename T> constexpr uint64_t basic_width_data<T>::wide_blocks[];
+
+// Returns true iff the code point cp occupies two columns.
+FMT_CONSTEXPR inline auto is_wide(uint32_t cp) -> bool {
+  using data = basic_width_data<>;
+  if (cp < 0x1100) return false;  // The first wide code point.
+  if (cp >= sizeof(data::wide_index) << 8) return false;
+  auto word = data::wide_blocks[data::wide_index[cp >> 8] * 4 + (cp >> 6 & 3)];
+  return (word >> (cp & 63) & 1) != 0;
+}
+
 template <typename Char>
 inline auto compute_width(basic_string_view<Char> s) -> size_t {
   return s.size();
@@ -572,31 +753,31 @@ FMT_CONSTEXPR inline size_t compute_width(string_view s) {
   // It is not a lambda for compatibility with C++14.
   struct count_code_points {
     size_t* count;
-    FMT_CONSTEXPR auto operator()(uint32_t cp, string_view) const -> bool {
-      *count += detail::to_unsigned(
-          1 +
-          (cp >= 0x1100 &&
-           (cp <= 0x115f ||  // Hangul Jamo init. consonants
-            cp == 0x2329 ||  // LEFT-POINTING ANGLE BRACKET
-            cp == 0x232a ||  // RIGHT-POINTING ANGLE BRACKET
-            // CJK ... Yi except IDEOGRAPHIC HALF FILL SPACE:
-            (cp >= 0x2e80 && cp <= 0xa4cf && cp != 0x303f) ||
-            (cp >= 0xac00 && cp <= 0xd7a3) ||    // Hangul Syllables
-            (cp >= 0xf900 && cp <= 0xfaff) ||    // CJK Compatibility Ideographs
-            (cp >= 0xfe10 && cp <= 0xfe19) ||    // Vertical Forms
-            (cp >= 0xfe30 && cp <= 0xfe6f) ||    // CJK Compatibility Forms
-            (cp >= 0xff00 && cp <= 0xff60) ||    // Fullwidth Forms
-            (cp >= 0xffe0 && cp <= 0xffe6) ||    // Fullwidth Forms
-            (cp >= 0x20000 && cp <= 0x2fffd) ||  // CJK
-            (cp >= 0x30000 && cp <= 0x3fffd) ||
-            // Miscellaneous Symbols and Pictographs + Emoticons:
-            (cp >= 0x1f300 && cp <= 0x1f64f) ||
-            // Supplemental Symbols and Pictographs:
-            (cp >= 0x1f900 && cp <= 0x1f9ff))));
+    // If not null, decoding stops at an ASCII character which is stored here.
+    const char** ascii;
+    FMT_CONSTEXPR auto operator()(uint32_t cp, string_view sv) const -> bool {
+      if (ascii && (static_cast<unsigned char>(*sv.data()) & 0x80) == 0) {
+        *ascii = sv.data();
+        return false;
+      }
+      *count += is_wide(cp) ? 2u : 1u;
       return true;
     }
   };
-  for_each_codepoint(s, count_code_points{&num_code_points});
+  if (is_constant_evaluated()) {
+    for_each_codepoint(s, count_code_points{&num_code_points, nullptr});
+    return num_code_points;
+  }
+  // Count ASCII runs in bulk and decode only the rest.
+  auto p = s.data(), end = s.data() + s.size();
+  for (;;) {
+    auto non_ascii = find_non_ascii(p, end);
+    num_code_points += to_unsigned(non_ascii - p);
+    if (non_ascii == end) break;
+    p = end;
+    for_each_codepoint(string_view(non_ascii, to_unsigned(end - non_ascii)),
+                       count_code_points{&num_code_points, &p});
+  }
   return num_code_points;
 }
 
@@ -615,11 +796,16 @@ inline auto code_point_index(basic_string_view<Char> s, size_t n) -> size_t {
 inline auto code_point_index(basic_string_view<char8_type> s, size_t n)
     -> size_t {
   const char8_type* data = s.data();
-  size_t num_code_points = 0;
-  for (size_t i = 0, size = s.size(); i != size; ++i) {
+  size_t size = s.size();
+  // Skip the ASCII prefix in bulk since each ASCII character is a code point.
+  auto begin = reinterpret_cast<const char*>(data);
+  size_t i = to_unsigned(find_non_ascii(begin, begin + (n < size ? n : size)) -
+                         begin);
+  size_t num_code_points = i;
+  for (; i != size; ++i) {
     if ((data[i] & 0xc0) != 0x80 && ++num_code_points > n) return i;
   }
-  return s.size();
+  return size;
 }
 
 template <typename T, bool = std::is_floating_point<T>::value>
@@ -627,10 +813,31 @@ struct is_fast_float : bool_constant<std::numeric_limits<T>::is_iec559 &&
                                      sizeof(T) <= sizeof(double)> {};
 template <typename T> struct is_fast_float<T, false> : std::false_type {};
 
+// Floating-point types that are not fast floats but whose values can be
+// represented exactly with a 64-bit significand and a binary exponent, e.g.
+// x87 80-bit long double. They are formatted with Dragon4 instead of snprintf.
+template <typename T, bool = std::is_floating_point<T>::value>
+struct is_fp_compatible
+    : bool_constant<!is_fast_float<T>::value &&
+                    std::numeric_limits<T>::radix == 2 &&
+                    std::numeric_limits<T>::digits <= 64> {};
+template <typename T> struct is_fp_compatible<T, false> : std::false_type {};
+
+// Selects the Dragonbox cache of powers of 10 used for double. The full table
+// (1) has 619 128-bit entries (~10 KB) and is a single lookup. The compressed
+// table (0, default) keeps every 27th entry (~0.7 KB with the recovery
+// tables) and restores the others with two 64x64 multiplications, which is
+// preferable when floats are formatted rarely and the table is cold.
 #ifndef FMT_USE_FULL_CACHE_DRAGONBOX
 #  define FMT_USE_FULL_CACHE_DRAGONBOX 0
 #endif
 
+// Use exact 128-bit integer arithmetic instead of Grisu with a Dragon4
+// fallback for the given precision when the scaled value fits.
+#ifndef FMT_USE_EXACT_FIXED_PRECISION
+#  define FMT_USE_EXACT_FIXED_PRECISION FMT_USE_INT128
+#endif
+
 template <typename T>
 template <typename U>
 void buffer<T>::append(const U* begin, const U* end) {
@@ -638,6 +845,7 @@ void buffer<T>::append(const U* begin, const U* end) {
     auto count = to_unsigned(end - begin);
     try_reserve(size_ + count);
     auto free_cap = capacity_ - size_;
+    if (free_cap == 0) return;  // The buffer discards the rest of the output.
     if (free_cap < count) count = free_cap;
     std::uninitialized_copy_n(begin, count, make_checked(ptr_ + size_, count));
     size_ += count;
@@ -813,6 +1021,7 @@ struct is_contiguous<basic_memory_buffer<T, SIZE, Allocator>> : std::true_type {
 
 namespace detail {
 FMT_API void print(std::FILE*, string_view);
+FMT_API auto is_terminal(std::FILE* f) -> bool;
 }
 
 /** A formatting error such as invalid format string. */
@@ -1141,6 +1350,44 @@ inline auto format_decimal(Iterator out, UInt value, int size)
   return {out, detail::copy_str_noinline<Char>(buffer, end, out)};
 }
 
+// Formats a decimal unsigned integer value with num_digits digits inserting sep
+// between groups of three digits. Digits are written right to left into a
+// buffer that must hold num_digits + (num_digits - 1) / 3 characters.
+template <typename Char, typename UInt>
+FMT_CONSTEXPR20 auto format_decimal_grouped3(Char* out, UInt value,
+                                             int num_digits, Char sep)
+    -> Char* {
+  int num_separators = (num_digits - 1) / 3;
+  out += num_digits + num_separators;
+  Char* end = out;
+  for (int i = 0; i < num_separators; ++i) {
+    auto group = static_cast<unsigned>(value % 1000);
+    value /= 1000;
+    out -= 2;
+    copy2(out, digits2(group % 100));
+    *--out = static_cast<Char>('0' + group / 100);
+    *--out = sep;
+  }
+  int head_digits = num_digits - num_separators * 3;
+  format_decimal(out - head_digits, value, head_digits);
+  return end;
+}
+
+template <typename Char, typename UInt, typename It,
+          FMT_ENABLE_IF(!std::is_pointer<remove_cvref_t<It>>::value)>
+inline auto format_decimal_grouped3(It out, UInt value, int num_digits,
+                                    Char sep) -> It {
+  auto size = to_unsigned(num_digits + (num_digits - 1) / 3);
+  if (auto ptr = to_pointer<Char>(out, size)) {
+    format_decimal_grouped3(ptr, value, num_digits, sep);
+    return out;
+  }
+  // Buffer is large enough to hold all digits and separators.
+  Char buffer[digits10<UInt>() + 1 + digits10<UInt>() / 3];
+  auto end = format_decimal_grouped3(buffer, value, num_digits, sep);
+  return detail::copy_str_noinline<Char>(buffer, end, out);
+}
+
 template <unsigned BASE_BITS, typename Char, typename UInt>
 FMT_CONSTEXPR auto format_uint(Char* buffer, UInt value, int num_digits,
                                bool upper = false) -> Char* {
@@ -1483,6 +1730,16 @@ template <typename Char> class digit_grouping {
 
   Char separator() const { return sep_.thousands_sep; }
 
+  // Returns true if digits are separated into groups of three, which is the
+  // case for group_digits and most locales.
+  bool has_groups_of_three() const {
+    if (!sep_.thousands_sep || sep_.grouping.empty()) return false;
+    for (char group : sep_.grouping) {
+      if (group != 3) return false;
+    }
+    return true;
+  }
+
   int count_separators(int num_digits) const {
     int count = 0;
     auto state = initial_state();
@@ -1519,6 +1776,16 @@ auto write_int_localized(OutputIt out, UInt value, unsigned prefix,
                          const digit_grouping<Char>& grouping) -> OutputIt {
   static_assert(std::is_same<uint64_or_128_t<UInt>, UInt>::value, "");
   int num_digits = count_digits(value);
+  if (grouping.has_groups_of_three()) {
+    auto sep = grouping.separator();
+    unsigned size = to_unsigned((prefix != 0 ? 1 : 0) + num_digits +
+                                (num_digits - 1) / 3);
+    return write_padded<align::right>(
+        out, specs, size, size, [=](reserve_iterator<OutputIt> it) {
+          if (prefix != 0) *it++ = static_cast<Char>(prefix);
+          return format_decimal_grouped3<Char>(it, value, num_digits, sep);
+        });
+  }
   char digits[40];
   format_decimal(digits, value, num_digits);
   unsigned size = to_unsigned((prefix != 0 ? 1 : 0) + num_digits +
@@ -2028,7 +2295,7 @@ FMT_CONSTEXPR20 auto write(OutputIt out, T value,
       ++precision;
   }
   if (const_check(std::is_same<T, float>())) fspecs.binary32 = true;
-  if (!is_fast_float<T>()) fspecs.fallback = true;
+  if (!is_fast_float<T>() && !is_fp_compatible<T>()) fspecs.fallback = true;
   int exp = format_float(promote_float(value), precision, fspecs, buffer);
   fspecs.precision = precision;
   auto fp = big_decimal_fp{buffer.data(), static_cast<int>(buffer.size()), exp};
@@ -2063,6 +2330,129 @@ FMT_CONSTEXPR20 auto write(OutputIt out, T value) -> OutputIt {
   return write_float(out, dec, specs, fspecs, {});
 }
 
+// A floating-point number prepared for writing in the shortest round-trip
+// format without format specifiers.
+template <typename T> struct shortest_float {
+  typename dragonbox::float_info<T>::carrier_uint significand;
+  int exponent;
+  int significand_size;  // 0 for infinity and NaN.
+  bool negative;
+  bool isinf;
+};
+
+template <typename T>
+inline auto make_shortest_float(T value) -> shortest_float<T> {
+  using uint = typename dragonbox::float_info<T>::carrier_uint;
+  auto result = shortest_float<T>();
+  result.negative = detail::signbit(value);
+  if (result.negative) value = -value;
+  uint mask = exponent_mask<T>();
+  if ((bit_cast<uint>(value) & mask) == mask) {
+    result.isinf = std::isinf(value);
+    return result;
+  }
+  auto dec = dragonbox::to_decimal(value);
+  result.significand = dec.significand;
+  result.exponent = dec.exponent;
+  result.significand_size = count_digits(dec.significand);
+  return result;
+}
+
+// Returns true if value should be written in the exponent notation. This
+// is the same choice that do_write_float makes for empty format specifiers.
+template <typename T>
+constexpr auto use_exp_format(const shortest_float<T>& value) -> bool {
+  return value.exponent + value.significand_size - 1 < -4 ||
+         value.exponent + value.significand_size - 1 >= 16;
+}
+
+template <typename T>
+FMT_CONSTEXPR auto get_size(const shortest_float<T>& value) -> size_t {
+  size_t size = value.negative ? 1 : 0;
+  int n = value.significand_size;
+  if (n == 0) return size + 3;
+  if (use_exp_format(value)) {
+    int output_exp = value.exponent + n - 1;
+    int abs_output_exp = output_exp >= 0 ? output_exp : -output_exp;
+    int exp_digits = 2;
+    if (abs_output_exp >= 100) exp_digits = abs_output_exp >= 1000 ? 4 : 3;
+    return size + to_unsigned(n + (n > 1 ? 1 : 0) + 2 + exp_digits);
+  }
+  if (value.exponent >= 0) return size + to_unsigned(n + value.exponent);
+  int exp = value.exponent + n;
+  if (exp > 0) return size + to_unsigned(n + 1);
+  return size + to_unsigned(2 - exp + n);
+}
+
+// Writes value into a buffer of at least get_size(value) code units.
+template <typename Char, typename T>
+auto write_shortest(Char* out, const shortest_float<T>& value) -> Char* {
+  if (value.negative) *out++ = static_cast<Char>('-');
+  int n = value.significand_size;
+  if (n == 0) {
+    const char* str = value.isinf ? "inf" : "nan";
+    return copy_str<Char>(str, str + 3, out);
+  }
+  if (use_exp_format(value)) {
+    auto decimal_point = n > 1 ? static_cast<Char>('.') : Char();
+    out = write_significand(out, value.significand, n, 1, decimal_point);
+    *out++ = static_cast<Char>('e');
+    return write_exponent<Char>(value.exponent + n - 1, out);
+  }
+  if (value.exponent >= 0) {
+    out = format_decimal(out, value.significand, n).end;
+    return detail::fill_n(out, value.exponent, static_cast<Char>('0'));
+  }
+  int exp = value.exponent + n;
+  if (exp > 0) {
+    return write_significand(out, value.significand, n, exp,
+                             static_cast<Char>('.'));
+  }
+  *out++ = static_cast<Char>('0');
+  *out++ = static_cast<Char>('.');
+  out = detail::fill_n(out, -exp, static_cast<Char>('0'));
+  return format_decimal(out, value.significand, n).end;
+}
+
+template <typename Char, typename T>
+auto write_shortest_floats(Char* out, const shortest_float<T>* values,
+                           size_t count, basic_string_view<Char> sep,
+                           bool leading_sep) -> Char* {
+  for (size_t i = 0; i < count; ++i) {
+    if (i != 0 || leading_sep)
+      out = copy_str<Char>(sep.begin(), sep.end(), out);
+    out = write_shortest(out, values[i]);
+  }
+  return out;
+}
+
+template <typename Char, typename OutputIt, typename T,
+          FMT_ENABLE_IF(!std::is_pointer<remove_cvref_t<OutputIt>>::value)>
+auto write_shortest_floats(OutputIt out, const shortest_float<T>* values,
+                           size_t count, basic_string_view<Char> sep,
+                           bool leading_sep, size_t size) -> OutputIt {
+  if (auto ptr = to_pointer<Char>(out, size)) {
+    write_shortest_floats(ptr, values, count, sep, leading_sep);
+    return out;
+  }
+  // Large enough to hold any float or double in the shortest format.
+  Char buffer[32];
+  for (size_t i = 0; i < count; ++i) {
+    if (i != 0 || leading_sep)
+      out = copy_str<Char>(sep.begin(), sep.end(), out);
+    out = copy_str_noinline<Char>(buffer, write_shortest(buffer, values[i]),
+                                  out);
+  }
+  return out;
+}
+
+template <typename Char, typename T>
+auto write_shortest_floats(Char* out, const shortest_float<T>* values,
+                           size_t count, basic_string_view<Char> sep,
+                           bool leading_sep, size_t) -> Char* {
+  return write_shortest_floats(out, values, count, sep, leading_sep);
+}
+
 template <typename Char, typename OutputIt, typename T,
           FMT_ENABLE_IF(std::is_floating_point<T>::value &&
                         !is_fast_float<T>::value)>
@@ -2774,6 +3164,140 @@ template <typename T> struct formatter<group_digits_view<T>> : formatter<T> {
   }
 };
 
+/**
+  \rst
+  A fixed-point decimal number ``value * pow(10, -Scale)`` stored as a scaled
+  integer such as an amount of money in cents. It is formatted exactly without
+  conversion to floating point and supports the same format specifiers as
+  ``double`` with the ``f`` presentation type. The number of decimal digits
+  defaults to *Scale*; a different precision pads with zeros or rounds half to
+  even.
+
+  **Example**::
+
+    fmt::print("{}", fmt::fixed_decimal<int64_t, 2>{-123456});
+    // Output: "-1234.56"
+    fmt::print("{:>10.1f}", fmt::fixed_decimal<int64_t, 2>{1225});
+    // Output: "      12.2"
+  \endrst
+ */
+template <typename Int, int Scale> struct fixed_decimal {
+  static_assert(Scale >= 0 && Scale <= 19, "scale is out of range");
+  Int value;
+};
+
+/**
+  A fixed-point decimal number ``value * pow(10, -scale)`` with the scale known
+  at runtime, otherwise the same as `~fmt::fixed_decimal`.
+ */
+template <typename Int> struct dynamic_fixed_decimal {
+  Int value;
+  int scale;
+};
+
+FMT_BEGIN_DETAIL_NAMESPACE
+
+// Writes abs_value * pow(10, -scale) rounded to specs.precision digits after
+// the decimal point.
+template <typename Char, typename OutputIt, typename UInt>
+auto write_fixed_decimal(OutputIt out, UInt abs_value, bool negative,
+                         int scale, basic_format_specs<Char> specs,
+                         locale_ref loc) -> OutputIt {
+  if (scale < 0 || scale > 19) throw_format_error("scale is out of range");
+  int precision = specs.precision >= 0 ? specs.precision : scale;
+  if (precision < scale) {
+    UInt divisor = 1;
+    for (int i = precision; i < scale; ++i) divisor *= 10;
+    UInt remainder = abs_value % divisor;
+    abs_value /= divisor;
+    // Round half to even.
+    if (remainder > divisor - remainder ||
+        (remainder == divisor - remainder && abs_value % 2 != 0))
+      ++abs_value;
+  }
+  auto fspecs = float_specs();
+  fspecs.format = float_format::fixed;
+  fspecs.precision = precision;
+  fspecs.showpoint = specs.alt;
+  fspecs.locale = specs.localized;
+  fspecs.sign = negative ? sign::minus : specs.sign;
+  if (fspecs.sign == sign::minus && !negative) fspecs.sign = sign::none;
+  if (specs.align == align::numeric && fspecs.sign) {
+    auto it = reserve(out, 1);
+    *it++ = detail::sign<Char>(fspecs.sign);
+    out = base_iterator(out, it);
+    fspecs.sign = sign::none;
+    if (specs.width != 0) --specs.width;
+  }
+  auto digits = memory_buffer();
+  int num_digits = count_digits(abs_value);
+  digits.resize(to_unsigned(num_digits));
+  format_decimal<char>(digits.data(), abs_value, num_digits);
+  if (precision > scale) {
+    digits.resize(to_unsigned(num_digits + precision - scale));
+    std::uninitialized_fill(digits.data() + num_digits, digits.end(), '0');
+  }
+  auto fp = big_decimal_fp{digits.data(), static_cast<int>(digits.size()),
+                           -precision};
+  return write_float(out, fp, specs, fspecs, loc);
+}
+
+template <typename Char> class fixed_decimal_formatter {
+ private:
+  dynamic_format_specs<Char> specs_;
+
+ public:
+  template <typename ParseContext>
+  FMT_CONSTEXPR auto parse(ParseContext& ctx) -> decltype(ctx.begin()) {
+    using handler_type = dynamic_specs_handler<ParseContext>;
+    specs_checker<handler_type> handler(handler_type(specs_, ctx),
+                                        type::double_type);
+    auto it = parse_format_specs(ctx.begin(), ctx.end(), handler);
+    if (specs_.type != presentation_type::none &&
+        specs_.type != presentation_type::fixed_lower &&
+        specs_.type != presentation_type::fixed_upper) {
+      ctx.on_error("invalid type specifier");
+    }
+    return it;
+  }
+
+  template <typename Int, typename FormatContext>
+  auto format(Int value, int scale, FormatContext& ctx) const
+      -> decltype(ctx.out()) {
+    auto specs = specs_;
+    handle_dynamic_spec<width_checker>(specs.width, specs.width_ref, ctx);
+    handle_dynamic_spec<precision_checker>(specs.precision,
+                                           specs.precision_ref, ctx);
+    auto abs_value = static_cast<uint64_or_128_t<Int>>(value);
+    bool negative = is_negative(value);
+    if (negative) abs_value = 0 - abs_value;
+    return write_fixed_decimal<Char>(ctx.out(), abs_value, negative, scale,
+                                     specs, ctx.locale());
+  }
+};
+
+FMT_END_DETAIL_NAMESPACE
+
+template <typename Int, int Scale, typename Char>
+struct formatter<fixed_decimal<Int, Scale>, Char>
+    : detail::fixed_decimal_formatter<Char> {
+  template <typename FormatContext>
+  auto format(fixed_decimal<Int, Scale> d, FormatContext& ctx) const
+      -> decltype(ctx.out()) {
+    return detail::fixed_decimal_formatter<Char>::format(d.value, Scale, ctx);
+  }
+};
+
+template <typename Int, typename Char>
+struct formatter<dynamic_fixed_decimal<Int>, Char>
+    : detail::fixed_decimal_formatter<Char> {
+  template <typename FormatContext>
+  auto format(dynamic_fixed_decimal<Int> d, FormatContext& ctx) const
+      -> decltype(ctx.out()) {
+    return detail::fixed_decimal_formatter<Char>::format(d.value, d.scale, ctx);
+  }
+};
+
 template <typename It, typename Sentinel, typename Char = char>
 struct join_view : detail::view {
   It begin;
@@ -2873,6 +3397,43 @@ auto join(Range&& range, string_view sep)
   return join(std::begin(range), std::end(range), sep);
 }
 
+/**
+  \rst
+  Formats floating-point numbers from the array ``[values, values + size)``
+  separated by `sep` in the shortest round-trip format, the same as ``{}``.
+  The values are converted in batches: the output size of a batch is computed
+  upfront and reserved once, so it is faster than formatting the numbers one by
+  one or with ``fmt::join``.
+
+  **Example**::
+
+    double values[] = {1.5, 0.1, 1e100};
+    std::string s;
+    fmt::format_floats(std::back_inserter(s), values, 3, ", ");
+    // s == "1.5, 0.1, 1e+100"
+  \endrst
+ */
+template <typename OutputIt, typename T,
+          FMT_ENABLE_IF(detail::is_fast_float<T>::value)>
+auto format_floats(OutputIt out, const T* values, size_t size, string_view sep)
+    -> OutputIt {
+  const size_t batch_size = 64;
+  detail::shortest_float<T> batch[batch_size];
+  for (size_t start = 0; start < size; start += batch_size) {
+    size_t count = size - start < batch_size ? size - start : batch_size;
+    size_t batch_chars = sep.size() * (start != 0 ? count : count - 1);
+    for (size_t i = 0; i < count; ++i) {
+      batch[i] = detail::make_shortest_float(values[start + i]);
+      batch_chars += detail::get_size(batch[i]);
+    }
+    auto it = detail::reserve(out, batch_chars);
+    it = detail::write_shortest_floats<char>(it, batch, count, sep, start != 0,
+                                             batch_chars);
+    out = detail::base_iterator(out, it);
+  }
+  return out;
+}
+
 /**
   \rst
   Converts *value* to ``std::string`` using the default format for type *T*.
@@ -2911,6 +3472,153 @@ FMT_NODISCARD auto to_string(const basic_memory_buffer<Char, SIZE>& buf)
 
 FMT_BEGIN_DETAIL_NAMESPACE
 
+// Loads 8 characters as a little-endian 64-bit integer.
+inline auto read_eight_chars(const char* p) -> uint64_t {
+  uint64_t chunk = 0;
+  if (!is_big_endian()) {
+    std::memcpy(&chunk, p, sizeof(chunk));
+    return chunk;
+  }
+  for (int i = 7; i >= 0; --i)
+    chunk = (chunk << 8) | static_cast<unsigned char>(p[i]);
+  return chunk;
+}
+
+// Checks if all 8 characters in a chunk loaded with read_eight_chars are
+// decimal digits using SWAR (SIMD within a register).
+inline auto is_eight_digits(uint64_t chunk) -> bool {
+  return (((chunk + 0x4646464646464646) | (chunk - 0x3030303030303030)) &
+          0x8080808080808080) == 0;
+}
+
+// Converts a chunk of 8 decimal digits to an integer with 3 multiplications.
+inline auto parse_eight_digits(uint64_t chunk) -> uint32_t {
+  const uint64_t mask = 0x000000ff000000ff;
+  const uint64_t mul1 = 100 + (1000000ULL << 32);
+  const uint64_t mul2 = 1 + (10000ULL << 32);
+  chunk -= 0x3030303030303030;
+  chunk = (chunk * 10) + (chunk >> 8);
+  chunk = (((chunk & mask) * mul1) + (((chunk >> 16) & mask) * mul2)) >> 32;
+  return static_cast<uint32_t>(chunk);
+}
+
+inline auto is_decimal_digit(char c) -> bool { return c >= '0' && c <= '9'; }
+
+// Parses at most max_digits decimal digits into n without overflow checks.
+inline auto parse_decimal(const char* begin, const char* end, int max_digits,
+                          uint64_t& n) -> const char* {
+  auto p = begin;
+  if (end - p > max_digits) end = p + max_digits;
+  for (; end - p >= 8; p += 8) {
+    uint64_t chunk = read_eight_chars(p);
+    if (!is_eight_digits(chunk)) break;
+    n = n * 100000000 + parse_eight_digits(chunk);
+  }
+  for (; p != end && is_decimal_digit(*p); ++p)
+    n = n * 10 + static_cast<unsigned>(*p - '0');
+  return p;
+}
+
+FMT_END_DETAIL_NAMESPACE
+
+/** A result of `~fmt::from_chars`, the same as ``std::from_chars_result``. */
+struct from_chars_result {
+  const char* ptr;
+  std::errc ec;
+};
+
+/**
+  \rst
+  Parses a decimal integer from ``[first, last)`` with the same semantics as
+  ``std::from_chars``: an optional ``-`` for signed types followed by digits,
+  no leading whitespace or ``+``. On error *value* is left unchanged and
+  ``ec`` is ``std::errc::invalid_argument`` or
+  ``std::errc::result_out_of_range``.
+
+  **Example**::
+
+    int value = 0;
+    auto result = fmt::from_chars(s.data(), s.data() + s.size(), value);
+  \endrst
+ */
+template <typename T,
+          FMT_ENABLE_IF(std::is_integral<T>::value &&
+                        !std::is_same<T, bool>::value &&
+                        sizeof(T) <= sizeof(uint64_t))>
+auto from_chars(const char* first, const char* last, T& value)
+    -> from_chars_result {
+  auto p = first;
+  bool negative = std::is_signed<T>::value && p != last && *p == '-';
+  if (negative) ++p;
+  auto digits_begin = p;
+  while (p != last && *p == '0') ++p;
+  // Up to 19 digits always fit in uint64_t.
+  uint64_t n = 0;
+  p = detail::parse_decimal(p, last, 19, n);
+  bool overflow = false;
+  if (p != last && detail::is_decimal_digit(*p)) {
+    auto digit = static_cast<unsigned>(*p++ - '0');
+    overflow = n > (detail::max_value<uint64_t>() - digit) / 10;
+    n = n * 10 + digit;
+    while (p != last && detail::is_decimal_digit(*p)) {
+      overflow = true;
+      ++p;
+    }
+  }
+  if (p == digits_begin) return {first, std::errc::invalid_argument};
+  auto max =
+      static_cast<uint64_t>(detail::max_value<T>()) + (negative ? 1 : 0);
+  if (overflow || n > max) return {p, std::errc::result_out_of_range};
+  value = static_cast<T>(negative ? 0 - n : n);
+  return {p, std::errc()};
+}
+
+/**
+  \rst
+  Parses a ``double`` from ``[first, last)`` with the same semantics as
+  ``std::from_chars`` with ``std::chars_format::general``: an optional ``-``,
+  a decimal significand with an optional exponent or ``inf``, ``infinity``,
+  ``nan`` (case-insensitive). The result is correctly rounded so that the
+  output of ``fmt::format("{}", value)`` is parsed back to the same *value*.
+  Values that overflow or underflow to zero give
+  ``std::errc::result_out_of_range``.
+  \endrst
+ */
+FMT_API auto from_chars(const char* first, const char* last, double& value)
+    -> from_chars_result;
+
+/** A result of `~fmt::to_chars`, the same as ``std::to_chars_result``. */
+struct to_chars_result {
+  char* ptr;
+  std::errc ec;
+};
+
+/**
+  \rst
+  Writes *value* to ``[first, last)`` in the shortest round-trip format, the
+  same as ``fmt::format("{}", value)``, without allocating or going through
+  format specifiers. The output is never longer than 24 characters for
+  ``double`` and 17 for ``float`` and is not null-terminated. If the range is
+  too small, returns ``{last, std::errc::value_too_large}``.
+
+  **Example**::
+
+    char buf[24];
+    auto result = fmt::to_chars(buf, buf + sizeof(buf), 0.1);
+    // std::string(buf, result.ptr) == "0.1"
+  \endrst
+ */
+template <typename T, FMT_ENABLE_IF(std::is_same<T, float>::value ||
+                                    std::is_same<T, double>::value)>
+auto to_chars(char* first, char* last, T value) -> to_chars_result {
+  auto shortest = detail::make_shortest_float(value);
+  if (detail::to_unsigned(last - first) < detail::get_size(shortest))
+    return {last, std::errc::value_too_large};
+  return {detail::write_shortest(first, shortest), std::errc()};
+}
+
+FMT_BEGIN_DETAIL_NAMESPACE
+
 template <typename Char>
 void vformat_to(
     buffer<Char>& buf, basic_string_view<Char> fmt,
@@ -3099,6 +3807,129 @@ FMT_INLINE auto format_to(OutputIt out, const Locale& loc,
   return vformat_to(out, loc, fmt, fmt::make_format_args(args...));
 }
 
+/**
+  \rst
+  Truncation options for `~fmt::format_to_n`. The end of output that doesn't
+  fit is replaced with ``marker`` and, unless ``count`` is set, the rest of it
+  is dropped as it is produced instead of being counted.
+  \endrst
+ */
+struct truncation {
+  string_view marker;
+  bool count;
+
+  explicit constexpr truncation(string_view m = {}, bool c = false)
+      : marker(m), count(c) {}
+};
+
+FMT_BEGIN_DETAIL_NAMESPACE
+
+// A buffer that writes up to a limit to an output iterator ending truncated
+// output with a marker. Once the output is known to be truncated the rest of
+// it is discarded as it is appended unless it should be counted.
+template <typename OutputIt, typename Char>
+class truncating_buffer final : public buffer<Char> {
+ private:
+  enum { buffer_size = 256 };
+  OutputIt out_;
+  basic_string_view<Char> marker_;
+  size_t limit_;
+  size_t count_ = 0;
+  bool count_all_;
+  bool truncated_ = false;
+  // Characters past limit_ - marker_.size() that are written only if the
+  // output is not truncated.
+  basic_memory_buffer<Char> tail_;
+  Char data_[buffer_size];
+
+ protected:
+  FMT_CONSTEXPR20 void grow(size_t capacity) override {
+    size_t requested = capacity - this->size();
+    flush();
+    // Make appending more than fits in data_ stop right away when discarding.
+    if (truncated_ && !count_all_)
+      this->set(data_, requested <= buffer_size ? buffer_size : 0);
+  }
+
+  void flush() {
+    auto size = this->size();
+    this->clear();
+    if (!truncated_) {
+      const Char* p = data_;
+      const Char* end = data_ + size;
+      size_t keep = limit_ - marker_.size();
+      if (count_ < keep) {
+        auto n = to_unsigned(end - p) < keep - count_
+                     ? to_unsigned(end - p)
+                     : keep - count_;
+        out_ = copy_str<Char>(p, p + n, out_);
+        p += n;
+      }
+      size_t room = marker_.size() + 1 - tail_.size();
+      tail_.append(p, to_unsigned(end - p) < room ? end : p + room);
+      truncated_ = tail_.size() > marker_.size();
+    }
+    count_ += size;
+  }
+
+ public:
+  truncating_buffer(OutputIt out, size_t n, basic_string_view<Char> marker,
+                    bool count)
+      : buffer<Char>(data_, 0, buffer_size),
+        out_(out),
+        marker_(marker.data(), marker.size() < n ? marker.size() : n),
+        limit_(n),
+        count_all_(count) {}
+
+  auto out() -> OutputIt {
+    flush();
+    auto s = truncated_ ? marker_
+                        : basic_string_view<Char>(tail_.data(), tail_.size());
+    return copy_str<Char>(s.begin(), s.end(), out_);
+  }
+  auto count() const -> size_t { return count_ + this->size(); }
+};
+
+FMT_END_DETAIL_NAMESPACE
+
+template <typename OutputIt,
+          FMT_ENABLE_IF(detail::is_output_iterator<OutputIt, char>::value)>
+auto vformat_to_n(OutputIt out, size_t n, const truncation& t,
+                  string_view fmt, format_args args)
+    -> format_to_n_result<OutputIt> {
+  detail::truncating_buffer<OutputIt, char> buf(out, n, t.marker, t.count);
+  detail::vformat_to(buf, fmt, args, {});
+  auto end = buf.out();
+  return {end, buf.count()};
+}
+
+/**
+  \rst
+  Formats ``args`` according to specifications in ``fmt`` and writes up to
+  ``n`` characters of the result to the output iterator ``out``. If the result
+  doesn't fit, its end is replaced with ``t.marker`` and, unless ``t.count`` is
+  set, the rest is dropped as soon as this is known so that long string
+  arguments and padding are not written. Padding with a fill character of
+  more than one code unit still takes time proportional to its width. Returns
+  the iterator past the end of the output range and the total output size if
+  it fits or ``t.count`` is set; otherwise the size is only guaranteed to
+  exceed ``n``.
+
+  **Example**::
+
+    char field[256];
+    auto result = fmt::format_to_n(field, sizeof(field),
+                                   fmt::truncation("..."), "{}", message);
+  \endrst
+ */
+template <typename OutputIt, typename... T,
+          FMT_ENABLE_IF(detail::is_output_iterator<OutputIt, char>::value)>
+FMT_INLINE auto format_to_n(OutputIt out, size_t n, const truncation& t,
+                            format_string<T...> fmt, T&&... args)
+    -> format_to_n_result<OutputIt> {
+  return vformat_to_n(out, n, t, fmt, fmt::make_format_args(args...));
+}
+
 FMT_MODULE_EXPORT_END
 FMT_END_NAMESPACE
 
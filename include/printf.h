@@ -11,6 +11,7 @@
 #include <algorithm>  // std::max
 #include <limits>     // std::numeric_limits
 #include <ostream>
+#include <vector>
 
 #include "format.h"
 
@@ -111,79 +112,6 @@ template <typename T> struct make_unsigned_or_bool : std::make_unsigned<T> {};
 
 template <> struct make_unsigned_or_bool<bool> { using type = bool; };
 
-template <typename T, typename Context> class arg_converter {
- private:
-  using char_type = typename Context::char_type;
-
-  basic_format_arg<Context>& arg_;
-  char_type type_;
-
- public:
-  arg_converter(basic_format_arg<Context>& arg, char_type type)
-      : arg_(arg), type_(type) {}
-
-  void operator()(bool value) {
-    if (type_ != 's') operator()<bool>(value);
-  }
-
-  template <typename U, FMT_ENABLE_IF(std::is_integral<U>::value)>
-  void operator()(U value) {
-    bool is_signed = type_ == 'd' || type_ == 'i';
-    using target_type = conditional_t<std::is_same<T, void>::value, U, T>;
-    if (const_check(sizeof(target_type) <= sizeof(int))) {
-      // Extra casts are used to silence warnings.
-      if (is_signed) {
-        arg_ = detail::make_arg<Context>(
-            static_cast<int>(static_cast<target_type>(value)));
-      } else {
-        using unsigned_type = typename make_unsigned_or_bool<target_type>::type;
-        arg_ = detail::make_arg<Context>(
-            static_cast<unsigned>(static_cast<unsigned_type>(value)));
-      }
-    } else {
-      if (is_signed) {
-        // glibc's printf doesn't sign extend arguments of smaller types:
-        //   std::printf("%lld", -42);  // prints "4294967254"
-        // but we don't have to do the same because it's a UB.
-        arg_ = detail::make_arg<Context>(static_cast<long long>(value));
-      } else {
-        arg_ = detail::make_arg<Context>(
-            static_cast<typename make_unsigned_or_bool<U>::type>(value));
-      }
-    }
-  }
-
-  template <typename U, FMT_ENABLE_IF(!std::is_integral<U>::value)>
-  void operator()(U) {}  // No conversion needed for non-integral types.
-};
-
-// Converts an integer argument to T for printf, if T is an integral type.
-// If T is void, the argument is converted to corresponding signed or unsigned
-// type depending on the type specifier: 'd' and 'i' - signed, other -
-// unsigned).
-template <typename T, typename Context, typename Char>
-void convert_arg(basic_format_arg<Context>& arg, Char type) {
-  visit_format_arg(arg_converter<T, Context>(arg, type), arg);
-}
-
-// Converts an integer argument to char for printf.
-template <typename Context> class char_converter {
- private:
-  basic_format_arg<Context>& arg_;
-
- public:
-  explicit char_converter(basic_format_arg<Context>& arg) : arg_(arg) {}
-
-  template <typename T, FMT_ENABLE_IF(std::is_integral<T>::value)>
-  void operator()(T value) {
-    arg_ = detail::make_arg<Context>(
-        static_cast<typename Context::char_type>(value));
-  }
-
-  template <typename T, FMT_ENABLE_IF(!std::is_integral<T>::value)>
-  void operator()(T) {}  // No conversion needed for non-integral types.
-};
-
 // An argument visitor that return a pointer to a C string if argument is a
 // string or null otherwise.
 template <typename Char> struct get_cstring {
@@ -300,9 +228,95 @@ class printf_arg_formatter : public arg_formatter<Char> {
   }
 };
 
+// A length modifier of a printf conversion specification.
+enum class printf_length : unsigned char { none, hh, h, l, ll, j, z, t, L };
+
+// Formats an integer argument converting it as printf does: to the type
+// specified by the length modifier or, if there is none, to the signed or
+// unsigned type of the same size depending on the conversion specifier
+// ('d' and 'i' - signed, other - unsigned). Unlike converting the argument
+// and visiting it again, this visits the argument only once.
+template <typename OutputIt, typename Char> class printf_int_formatter {
+ private:
+  printf_arg_formatter<OutputIt, Char> formatter_;
+  printf_length length_;
+  char type_;
+
+  template <typename T> auto write(T value) -> OutputIt {
+    if (type_ == 'c') return formatter_(static_cast<Char>(value));
+    const auto& specs = formatter_.specs;
+    if (const_check(!std::is_same<T, bool>::value) && specs.width == 0 &&
+        specs.precision < 0 && specs.sign == sign::none && !specs.alt &&
+        specs.type == presentation_type::dec) {
+      return detail::write<Char>(formatter_.out, value);
+    }
+    return formatter_(value);
+  }
+
+  template <typename T, typename U> auto convert(U value) -> OutputIt {
+    bool is_signed = type_ == 'd' || type_ == 'i';
+    using target_type = conditional_t<std::is_same<T, void>::value, U, T>;
+    if (const_check(sizeof(target_type) <= sizeof(int))) {
+      // Extra casts are used to silence warnings.
+      if (is_signed)
+        return write(static_cast<int>(static_cast<target_type>(value)));
+      using unsigned_type = typename make_unsigned_or_bool<target_type>::type;
+      return write(static_cast<unsigned>(static_cast<unsigned_type>(value)));
+    }
+    // glibc's printf doesn't sign extend arguments of smaller types:
+    //   std::printf("%lld", -42);  // prints "4294967254"
+    // but we don't have to do the same because it's a UB.
+    if (is_signed) return write(static_cast<long long>(value));
+    return write(static_cast<typename make_unsigned_or_bool<U>::type>(value));
+  }
+
+ public:
+  printf_int_formatter(printf_arg_formatter<OutputIt, Char> formatter,
+                       printf_length length, char type)
+      : formatter_(formatter), length_(length), type_(type) {}
+
+  auto operator()(bool value) -> OutputIt {
+    if (type_ == 's') return formatter_(value);
+    return operator()<bool>(value);
+  }
+
+  template <typename U, FMT_ENABLE_IF(std::is_integral<U>::value)>
+  auto operator()(U value) -> OutputIt {
+    switch (length_) {
+    case printf_length::none:
+      return convert<void>(value);
+    case printf_length::hh:
+      return convert<signed char>(value);
+    case printf_length::h:
+      return convert<short>(value);
+    case printf_length::l:
+      return convert<long>(value);
+    case printf_length::ll:
+      return convert<long long>(value);
+    case printf_length::j:
+      return convert<intmax_t>(value);
+    case printf_length::z:
+      return convert<size_t>(value);
+    case printf_length::t:
+      return convert<std::ptrdiff_t>(value);
+    case printf_length::L:
+      // printf produces garbage when 'L' is omitted for long double, no
+      // need to do the same.
+      break;
+    }
+    if (type_ == 'c') return formatter_(static_cast<Char>(value));
+    return formatter_(value);
+  }
+
+  template <typename U, FMT_ENABLE_IF(!std::is_integral<U>::value)>
+  auto operator()(U value) -> OutputIt {
+    return formatter_(value);
+  }
+};
+
 template <typename Char>
-void parse_flags(basic_format_specs<Char>& specs, const Char*& it,
-                 const Char* end) {
+FMT_CONSTEXPR void parse_flags(basic_format_specs<Char>& specs,
+                               const Char*& it, const Char* end) {
   for (; it != end; ++it) {
     switch (*it) {
     case '-':
@@ -328,10 +342,36 @@ void parse_flags(basic_format_specs<Char>& specs, const Char*& it,
   }
 }
 
-template <typename Char, typename GetArg>
-int parse_header(const Char*& it, const Char* end,
-                 basic_format_specs<Char>& specs, GetArg get_arg) {
+// A parsed printf conversion specification. Argument indices are resolved
+// during parsing while '*' widths and precisions are read from the arguments
+// during formatting.
+template <typename Char> struct printf_spec {
+  basic_format_specs<Char> specs;
+  int arg_index = 0;
+  int width_index = -1;
+  int precision_index = -1;
+  printf_length length = printf_length::none;
+  char type = 0;
+};
+
+// Returns the index of the argument with the specified one-based index or,
+// if arg_index is -1, of the next argument.
+template <typename Char>
+FMT_CONSTEXPR auto printf_arg_index(basic_printf_parse_context<Char>& ctx,
+                                    int arg_index) -> int {
+  if (arg_index < 0) return ctx.next_arg_id();
+  ctx.check_arg_id(--arg_index);
+  return arg_index;
+}
+
+template <typename Char>
+FMT_CONSTEXPR auto parse_header(const Char*& it, const Char* end,
+                                printf_spec<Char>& spec,
+                                basic_printf_parse_context<Char>& ctx)
+    -> int {
+  auto& specs = spec.specs;
   int arg_index = -1;
+  if (it == end) return arg_index;
   Char c = *it;
   if (c >= '0' && c <= '9') {
     // Parse an argument index (if followed by '$') or a width possibly
@@ -345,7 +385,7 @@ int parse_header(const Char*& it, const Char* end,
       if (value != 0) {
         // Nonzero value means that we parsed width and don't need to
         // parse it or flags again, so return now.
-        if (value == -1) FMT_THROW(format_error("number is too big"));
+        if (value == -1) ctx.on_error("number is too big");
         specs.width = value;
         return arg_index;
       }
@@ -356,168 +396,220 @@ int parse_header(const Char*& it, const Char* end,
   if (it != end) {
     if (*it >= '0' && *it <= '9') {
       specs.width = parse_nonnegative_int(it, end, -1);
-      if (specs.width == -1) FMT_THROW(format_error("number is too big"));
+      if (specs.width == -1) ctx.on_error("number is too big");
     } else if (*it == '*') {
       ++it;
-      specs.width = static_cast<int>(visit_format_arg(
-          detail::printf_width_handler<Char>(specs), get_arg(-1)));
+      spec.width_index = printf_arg_index(ctx, -1);
     }
   }
   return arg_index;
 }
 
-template <typename Char, typename Context>
-void vprintf(buffer<Char>& buf, basic_string_view<Char> format,
-             basic_format_args<Context> args) {
-  using OutputIt = buffer_appender<Char>;
-  auto out = OutputIt(buf);
-  auto context = basic_printf_context<OutputIt, Char>(out, args);
-  auto parse_ctx = basic_printf_parse_context<Char>(format);
-
-  // Returns the argument with specified index or, if arg_index is -1, the next
-  // argument.
-  auto get_arg = [&](int arg_index) {
-    if (arg_index < 0)
-      arg_index = parse_ctx.next_arg_id();
-    else
-      parse_ctx.check_arg_id(--arg_index);
-    return detail::get_arg(context, arg_index);
-  };
-
-  const Char* start = parse_ctx.begin();
-  const Char* end = parse_ctx.end();
-  auto it = start;
-  while (it != end) {
-    if (!detail::find<false, Char>(it, end, '%', it)) {
-      it = end;  // detail::find leaves it == nullptr if it doesn't find '%'
-      break;
-    }
-    Char c = *it++;
-    if (it != end && *it == c) {
-      out = detail::write(
-          out, basic_string_view<Char>(start, detail::to_unsigned(it - start)));
-      start = ++it;
-      continue;
-    }
-    out = detail::write(out, basic_string_view<Char>(
-                                 start, detail::to_unsigned(it - 1 - start)));
-
-    basic_format_specs<Char> specs;
-    specs.align = align::right;
-
-    // Parse argument index, flags and width.
-    int arg_index = parse_header(it, end, specs, get_arg);
-    if (arg_index == 0) parse_ctx.on_error("argument not found");
-
-    // Parse precision.
-    if (it != end && *it == '.') {
+// Parses a conversion specification following '%'.
+template <typename Char>
+FMT_CONSTEXPR auto parse_printf_spec(const Char*& it, const Char* end,
+                                     basic_printf_parse_context<Char>& ctx)
+    -> printf_spec<Char> {
+  auto spec = printf_spec<Char>();
+  spec.specs.align = align::right;
+
+  // Parse argument index, flags and width.
+  int arg_index = parse_header(it, end, spec, ctx);
+  if (arg_index == 0) ctx.on_error("argument not found");
+
+  // Parse precision.
+  if (it != end && *it == '.') {
+    ++it;
+    Char c = it != end ? *it : Char();
+    if ('0' <= c && c <= '9') {
+      spec.specs.precision = parse_nonnegative_int(it, end, 0);
+    } else if (c == '*') {
       ++it;
-      c = it != end ? *it : 0;
-      if ('0' <= c && c <= '9') {
-        specs.precision = parse_nonnegative_int(it, end, 0);
-      } else if (c == '*') {
-        ++it;
-        specs.precision = static_cast<int>(
-            visit_format_arg(detail::printf_precision_handler(), get_arg(-1)));
-      } else {
-        specs.precision = 0;
-      }
-    }
-
-    auto arg = get_arg(arg_index);
-    // For d, i, o, u, x, and X conversion specifiers, if a precision is
-    // specified, the '0' flag is ignored
-    if (specs.precision >= 0 && arg.is_integral())
-      specs.fill[0] =
-          ' ';  // Ignore '0' flag for non-numeric types or if '-' present.
-    if (specs.precision >= 0 && arg.type() == detail::type::cstring_type) {
-      auto str = visit_format_arg(detail::get_cstring<Char>(), arg);
-      auto str_end = str + specs.precision;
-      auto nul = std::find(str, str_end, Char());
-      arg = detail::make_arg<basic_printf_context<OutputIt, Char>>(
-          basic_string_view<Char>(
-              str, detail::to_unsigned(nul != str_end ? nul - str
-                                                      : specs.precision)));
-    }
-    if (specs.alt && visit_format_arg(detail::is_zero_int(), arg))
-      specs.alt = false;
-    if (specs.fill[0] == '0') {
-      if (arg.is_arithmetic() && specs.align != align::left)
-        specs.align = align::numeric;
-      else
-        specs.fill[0] = ' ';  // Ignore '0' flag for non-numeric types or if '-'
-                              // flag is also present.
+      spec.precision_index = printf_arg_index(ctx, -1);
+    } else {
+      spec.specs.precision = 0;
     }
+  }
+  spec.arg_index = printf_arg_index(ctx, arg_index);
 
-    // Parse length and convert the argument to the required type.
-    c = it != end ? *it++ : 0;
-    Char t = it != end ? *it : 0;
-    using detail::convert_arg;
-    switch (c) {
+  // Parse length.
+  if (it != end) {
+    switch (*it) {
     case 'h':
-      if (t == 'h') {
+      ++it;
+      spec.length = printf_length::h;
+      if (it != end && *it == 'h') {
         ++it;
-        t = it != end ? *it : 0;
-        convert_arg<signed char>(arg, t);
-      } else {
-        convert_arg<short>(arg, t);
+        spec.length = printf_length::hh;
       }
       break;
     case 'l':
-      if (t == 'l') {
+      ++it;
+      spec.length = printf_length::l;
+      if (it != end && *it == 'l') {
         ++it;
-        t = it != end ? *it : 0;
-        convert_arg<long long>(arg, t);
-      } else {
-        convert_arg<long>(arg, t);
+        spec.length = printf_length::ll;
       }
       break;
     case 'j':
-      convert_arg<intmax_t>(arg, t);
+      ++it;
+      spec.length = printf_length::j;
       break;
     case 'z':
-      convert_arg<size_t>(arg, t);
+      ++it;
+      spec.length = printf_length::z;
       break;
     case 't':
-      convert_arg<std::ptrdiff_t>(arg, t);
+      ++it;
+      spec.length = printf_length::t;
       break;
     case 'L':
-      // printf produces garbage when 'L' is omitted for long double, no
-      // need to do the same.
+      ++it;
+      spec.length = printf_length::L;
       break;
-    default:
-      --it;
-      convert_arg<void>(arg, c);
     }
+  }
 
-    // Parse type.
-    if (it == end) FMT_THROW(format_error("invalid format string"));
-    char type = static_cast<char>(*it++);
-    if (arg.is_integral()) {
-      // Normalize type.
-      switch (type) {
-      case 'i':
-      case 'u':
-        type = 'd';
-        break;
-      case 'c':
-        visit_format_arg(
-            detail::char_converter<basic_printf_context<OutputIt, Char>>(arg),
-            arg);
-        break;
-      }
-    }
-    specs.type = parse_presentation_type(type);
-    if (specs.type == presentation_type::none)
-      parse_ctx.on_error("invalid type specifier");
+  // Parse type.
+  if (it == end) ctx.on_error("invalid format string");
+  spec.type = static_cast<char>(*it++);
+  if (parse_presentation_type(spec.type) == presentation_type::none &&
+      spec.type != 'i' && spec.type != 'u') {
+    ctx.on_error("invalid type specifier");
+  }
+  return spec;
+}
 
+// Parses a printf format string calling handler.on_text for literal text
+// and handler.on_spec for each conversion specification.
+template <bool IS_CONSTEXPR, typename Char, typename Handler>
+FMT_CONSTEXPR void parse_printf_format(basic_string_view<Char> format,
+                                       Handler&& handler) {
+  auto ctx = basic_printf_parse_context<Char>(format);
+  const Char* start = format.data();
+  const Char* end = start + format.size();
+  auto it = start;
+  while (it != end) {
+    if (!detail::find<IS_CONSTEXPR, Char>(it, end, '%', it)) break;
+    ++it;
+    if (it != end && *it == '%') {
+      handler.on_text(start, it);
+      start = ++it;
+      continue;
+    }
+    handler.on_text(start, it - 1);
+    handler.on_spec(parse_printf_spec(it, end, ctx));
     start = it;
+  }
+  handler.on_text(start, end);
+}
+
+// Formats an argument according to a parsed conversion specification.
+template <typename OutputIt, typename Char>
+auto format_printf_arg(OutputIt out, const printf_spec<Char>& spec,
+                       basic_printf_context<OutputIt, Char>& context)
+    -> OutputIt {
+  auto specs = spec.specs;
+  if (spec.width_index >= 0) {
+    specs.width = static_cast<int>(
+        visit_format_arg(detail::printf_width_handler<Char>(specs),
+                         detail::get_arg(context, spec.width_index)));
+  }
+  if (spec.precision_index >= 0) {
+    specs.precision = static_cast<int>(
+        visit_format_arg(detail::printf_precision_handler(),
+                         detail::get_arg(context, spec.precision_index)));
+  }
+
+  auto arg = detail::get_arg(context, spec.arg_index);
+  // For d, i, o, u, x, and X conversion specifiers, if a precision is
+  // specified, the '0' flag is ignored
+  if (specs.precision >= 0 && arg.is_integral())
+    specs.fill[0] =
+        ' ';  // Ignore '0' flag for non-numeric types or if '-' present.
+  if (specs.precision >= 0 && arg.type() == detail::type::cstring_type) {
+    auto str = visit_format_arg(detail::get_cstring<Char>(), arg);
+    auto str_end = str + specs.precision;
+    auto nul = std::find(str, str_end, Char());
+    arg = detail::make_arg<basic_printf_context<OutputIt, Char>>(
+        basic_string_view<Char>(
+            str, detail::to_unsigned(nul != str_end ? nul - str
+                                                    : specs.precision)));
+  }
+  if (specs.alt && visit_format_arg(detail::is_zero_int(), arg))
+    specs.alt = false;
+  if (specs.fill[0] == '0') {
+    if (arg.is_arithmetic() && specs.align != align::left)
+      specs.align = align::numeric;
+    else
+      specs.fill[0] = ' ';  // Ignore '0' flag for non-numeric types or if '-'
+                            // flag is also present.
+  }
+
+  char type = spec.type;
+  // Normalize type.
+  if (arg.is_integral() && (type == 'i' || type == 'u')) type = 'd';
+  specs.type = parse_presentation_type(type);
+  if (specs.type == presentation_type::none)
+    context.on_error("invalid type specifier");
+
+  auto formatter = printf_arg_formatter<OutputIt, Char>(out, specs, context);
+  if (!arg.is_integral()) return visit_format_arg(formatter, arg);
+  return visit_format_arg(
+      printf_int_formatter<OutputIt, Char>(formatter, spec.length, spec.type),
+      arg);
+}
+
+template <typename Char, typename Context>
+void vprintf(buffer<Char>& buf, basic_string_view<Char> format,
+             basic_format_args<Context> args) {
+  struct handler {
+    buffer_appender<Char> out;
+    basic_printf_context<buffer_appender<Char>, Char> context;
+
+    void on_text(const Char* begin, const Char* end) {
+      out = detail::write(
+          out, basic_string_view<Char>(begin, to_unsigned(end - begin)));
+    }
+    void on_spec(const printf_spec<Char>& spec) {
+      out = format_printf_arg(out, spec, context);
+    }
+  };
+  auto out = buffer_appender<Char>(buf);
+  parse_printf_format<false>(format, handler{out, {out, args}});
+}
+
+// A conversion specification together with the size of the literal text
+// preceding it.
+template <typename Char> struct printf_part {
+  size_t text_size = 0;
+  printf_spec<Char> spec;
+};
 
-    // Format argument.
-    out = visit_format_arg(
-        detail::printf_arg_formatter<OutputIt, Char>(out, specs, context), arg);
+// A parsed printf format string: literal text with "%%" replaced by '%' and
+// conversion specifications to be formatted between its pieces.
+template <typename Char> struct printf_format_view {
+  basic_string_view<Char> text;
+  const printf_part<Char>* parts;
+  size_t num_parts;
+};
+
+template <typename Char, typename Context>
+void vprintf(buffer<Char>& buf, printf_format_view<Char> format,
+             basic_format_args<Context> args) {
+  using OutputIt = buffer_appender<Char>;
+  auto out = OutputIt(buf);
+  auto context = basic_printf_context<OutputIt, Char>(out, args);
+  const Char* text = format.text.data();
+  for (size_t i = 0; i < format.num_parts; ++i) {
+    const auto& part = format.parts[i];
+    out = detail::write(out, basic_string_view<Char>(text, part.text_size));
+    text += part.text_size;
+    out = format_printf_arg(out, part.spec, context);
   }
-  detail::write(out, basic_string_view<Char>(start, to_unsigned(it - start)));
+  const Char* text_end = format.text.data() + format.text.size();
+  detail::write(out,
+                basic_string_view<Char>(text, to_unsigned(text_end - text)));
 }
 FMT_END_DETAIL_NAMESPACE
 
@@ -555,13 +647,152 @@ inline auto make_wprintf_args(const T&... args)
   return {args...};
 }
 
-template <typename S, typename Char = char_t<S>>
+/**
+  \rst
+  A printf format string that is parsed once and can then be used to format
+  arguments many times without parsing it again. The format string is copied
+  so it doesn't need to outlive the object.
+
+  **Example**::
+
+    static const auto format = fmt::printf_format("%-10s %5d\n");
+    std::string s = fmt::sprintf(format, "items", 42);
+
+  A format string wrapped in ``FMT_STRING`` is parsed at compile time instead
+  if ``constexpr`` is supported::
+
+    std::string s = fmt::sprintf(FMT_STRING("%-10s %5d\n"), "items", 42);
+  \endrst
+ */
+template <typename Char> class basic_printf_format {
+ private:
+  std::basic_string<Char> text_;
+  std::vector<detail::printf_part<Char>> parts_;
+
+ public:
+  explicit basic_printf_format(basic_string_view<Char> format) {
+    struct handler {
+      basic_printf_format& self;
+      size_t part_start;
+
+      void on_text(const Char* begin, const Char* end) {
+        self.text_.append(begin, end);
+      }
+      void on_spec(const detail::printf_spec<Char>& spec) {
+        auto part = detail::printf_part<Char>();
+        part.text_size = self.text_.size() - part_start;
+        part.spec = spec;
+        self.parts_.push_back(part);
+        part_start = self.text_.size();
+      }
+    };
+    detail::parse_printf_format<false>(format, handler{*this, 0});
+  }
+
+  // Returns the parsed format string for use by the printf functions.
+  auto view() const -> detail::printf_format_view<Char> {
+    return {text_, parts_.data(), parts_.size()};
+  }
+};
+
+using printf_format = basic_printf_format<char>;
+using wprintf_format = basic_printf_format<wchar_t>;
+
+FMT_BEGIN_DETAIL_NAMESPACE
+
+// A printf format string parsed at compile time.
+template <typename Char, size_t NUM_PARTS, size_t TEXT_SIZE>
+struct static_printf_format {
+  printf_part<Char> parts[NUM_PARTS];
+  Char text[TEXT_SIZE] = {};
+  size_t num_parts = 0;
+  size_t text_size = 0;
+  size_t part_start = 0;
+
+  FMT_CONSTEXPR void on_text(const Char* begin, const Char* end) {
+    for (; begin != end; ++begin) text[text_size++] = *begin;
+  }
+  FMT_CONSTEXPR void on_spec(const printf_spec<Char>& spec) {
+    auto& part = parts[num_parts++];
+    part.text_size = text_size - part_start;
+    part.spec = spec;
+    part_start = text_size;
+  }
+};
+
+// Returns an upper bound on the number of conversions in a format string.
+template <typename Char>
+FMT_CONSTEXPR auto count_printf_specs(basic_string_view<Char> format)
+    -> size_t {
+  size_t count = 0;
+  for (auto c : format) count += c == '%' ? 1 : 0;
+  return count;
+}
+
+template <typename Char, size_t NUM_PARTS, size_t TEXT_SIZE>
+FMT_CONSTEXPR auto parse_static_printf_format(basic_string_view<Char> format)
+    -> static_printf_format<Char, NUM_PARTS, TEXT_SIZE> {
+  auto result = static_printf_format<Char, NUM_PARTS, TEXT_SIZE>();
+  parse_printf_format<true>(format, result);
+  return result;
+}
+
+template <typename S, typename = void>
+struct printf_char_impl : char_t_impl<S> {};
+template <typename Char>
+struct printf_char_impl<basic_printf_format<Char>> {
+  using type = Char;
+};
+template <typename Char> struct printf_char_impl<printf_format_view<Char>> {
+  using type = Char;
+};
+
+// The character type of a printf format string or a parsed format.
+template <typename S> using printf_char_t = typename printf_char_impl<S>::type;
+
+template <typename S, FMT_ENABLE_IF(!is_compile_string<S>::value)>
+auto to_printf_format(const S& format) -> basic_string_view<char_t<S>> {
+  return to_string_view(format);
+}
+
+// Parses a compile-time format string once, at compile time if possible.
+template <typename S, FMT_ENABLE_IF(is_compile_string<S>::value)>
+auto to_printf_format(const S& format) -> printf_format_view<char_t<S>> {
+  using char_type = char_t<S>;
+#if FMT_USE_CONSTEXPR
+  ignore_unused(format);
+  constexpr auto str = basic_string_view<char_type>(S());
+  static constexpr auto parsed =
+      parse_static_printf_format<char_type, count_printf_specs(str) + 1,
+                                 str.size() + 1>(str);
+  return {{parsed.text, parsed.text_size}, parsed.parts, parsed.num_parts};
+#else
+  static const auto parsed = basic_printf_format<char_type>(format);
+  return parsed.view();
+#endif
+}
+
+template <typename Char>
+auto to_printf_format(const basic_printf_format<Char>& format)
+    -> printf_format_view<Char> {
+  return format.view();
+}
+
+template <typename Char>
+auto to_printf_format(printf_format_view<Char> format)
+    -> printf_format_view<Char> {
+  return format;
+}
+
+FMT_END_DETAIL_NAMESPACE
+
+template <typename S, typename Char = detail::printf_char_t<S>>
 inline auto vsprintf(
     const S& fmt,
     basic_format_args<basic_printf_context_t<type_identity_t<Char>>> args)
     -> std::basic_string<Char> {
   basic_memory_buffer<Char> buffer;
-  vprintf(buffer, to_string_view(fmt), args);
+  vprintf(buffer, detail::to_printf_format(fmt), args);
   return to_string(buffer);
 }
 
@@ -575,19 +806,56 @@ inline auto vsprintf(
   \endrst
 */
 template <typename S, typename... T,
-          typename Char = enable_if_t<detail::is_string<S>::value, char_t<S>>>
+          typename Char = detail::printf_char_t<S>>
 inline auto sprintf(const S& fmt, const T&... args) -> std::basic_string<Char> {
   using context = basic_printf_context_t<Char>;
-  return vsprintf(to_string_view(fmt), fmt::make_format_args<context>(args...));
+  return vsprintf(detail::to_printf_format(fmt),
+                  fmt::make_format_args<context>(args...));
 }
 
-template <typename S, typename Char = char_t<S>>
+template <typename S, typename Char = detail::printf_char_t<S>>
+inline auto vsnprintf_to(
+    Char* out, size_t n, const S& fmt,
+    basic_format_args<basic_printf_context_t<type_identity_t<Char>>> args)
+    -> int {
+  // Reserve space for the terminating null character.
+  using traits = detail::fixed_buffer_traits;
+  detail::iterator_buffer<Char*, Char, traits> buf(out, n != 0 ? n - 1 : 0);
+  vprintf(buf, detail::to_printf_format(fmt), args);
+  if (n != 0) *buf.out() = Char();
+  return static_cast<int>(buf.count());
+}
+
+/**
+  \rst
+  Formats arguments like ``std::snprintf``: writes at most ``n - 1``
+  characters of the output directly to ``out``, null-terminates it if ``n`` is
+  nonzero and returns the size of the full (not truncated) output. Doesn't
+  allocate memory for the output.
+
+  **Example**::
+
+    char buf[8];
+    int size = fmt::snprintf_to(buf, sizeof(buf), "%s=%d", "answer", 42);
+    // buf contains "answer=" and size is 9.
+  \endrst
+*/
+template <typename S, typename... T,
+          typename Char = detail::printf_char_t<S>>
+inline auto snprintf_to(Char* out, size_t n, const S& fmt, const T&... args)
+    -> int {
+  using context = basic_printf_context_t<Char>;
+  return vsnprintf_to(out, n, detail::to_printf_format(fmt),
+                      fmt::make_format_args<context>(args...));
+}
+
+template <typename S, typename Char = detail::printf_char_t<S>>
 inline auto vfprintf(
     std::FILE* f, const S& fmt,
     basic_format_args<basic_printf_context_t<type_identity_t<Char>>> args)
     -> int {
   basic_memory_buffer<Char> buffer;
-  vprintf(buffer, to_string_view(fmt), args);
+  vprintf(buffer, detail::to_printf_format(fmt), args);
   size_t size = buffer.size();
   return std::fwrite(buffer.data(), sizeof(Char), size, f) < size
              ? -1
@@ -603,19 +871,19 @@ inline auto vfprintf(
     fmt::fprintf(stderr, "Don't %s!", "panic");
   \endrst
  */
-template <typename S, typename... T, typename Char = char_t<S>>
+template <typename S, typename... T, typename Char = detail::printf_char_t<S>>
 inline auto fprintf(std::FILE* f, const S& fmt, const T&... args) -> int {
   using context = basic_printf_context_t<Char>;
-  return vfprintf(f, to_string_view(fmt),
+  return vfprintf(f, detail::to_printf_format(fmt),
                   fmt::make_format_args<context>(args...));
 }
 
-template <typename S, typename Char = char_t<S>>
+template <typename S, typename Char = detail::printf_char_t<S>>
 inline auto vprintf(
     const S& fmt,
     basic_format_args<basic_printf_context_t<type_identity_t<Char>>> args)
     -> int {
-  return vfprintf(stdout, to_string_view(fmt), args);
+  return vfprintf(stdout, detail::to_printf_format(fmt), args);
 }
 
 /**
@@ -627,11 +895,12 @@ inline auto vprintf(
     fmt::printf("Elapsed time: %.2f seconds", 1.23);
   \endrst
  */
-template <typename S, typename... T, FMT_ENABLE_IF(detail::is_string<S>::value)>
+template <typename S, typename... T,
+          typename Char = detail::printf_char_t<S>>
 inline auto printf(const S& fmt, const T&... args) -> int {
   return vprintf(
-      to_string_view(fmt),
-      fmt::make_format_args<basic_printf_context_t<char_t<S>>>(args...));
+      detail::to_printf_format(fmt),
+      fmt::make_format_args<basic_printf_context_t<Char>>(args...));
 }
 
 template <typename S, typename Char = char_t<S>>
@@ -441,18 +441,50 @@ auto find_escape(const Char* begin, const Char* end)
   return {begin, nullptr, 0};
 }
 
+// Returns a pointer to the first character in [begin, end) that is not
+// printable ASCII or is a quote or a backslash, checking 8 characters at a time.
+inline auto find_escape_candidate(const char* begin, const char* end)
+    -> const char* {
+  constexpr uint64_t ones = 0x0101010101010101, highs = ones * 0x80;
+  for (; end - begin >= 8; begin += 8) {
+    uint64_t chunk = 0;
+    std::memcpy(&chunk, begin, sizeof(chunk));
+    // Sets the high bit of each byte that is zero.
+    auto zeros = [=](uint64_t x) { return (x - ones) & ~x & highs; };
+    auto special = (chunk - ones * 0x20) | (chunk + ones * 0x01) |
+                   zeros(chunk ^ (ones * '"')) | zeros(chunk ^ (ones * '\\'));
+    if ((special | chunk) & highs) break;
+  }
+  for (; begin != end; ++begin) {
+    auto c = static_cast<unsigned char>(*begin);
+    if (c < 0x20 || c >= 0x7f || c == '"' || c == '\\') break;
+  }
+  return begin;
+}
+
 inline auto find_escape(const char* begin, const char* end)
     -> find_escape_result<char> {
   if (!is_utf8()) return find_escape<char>(begin, end);
   auto result = find_escape_result<char>{end, nullptr, 0};
-  for_each_codepoint(string_view(begin, to_unsigned(end - begin)),
-                     [&](uint32_t cp, string_view sv) {
-                       if (needs_escape(cp)) {
-                         result = {sv.begin(), sv.end(), cp};
-                         return false;
-                       }
-                       return true;
-                     });
+  // Skip runs of printable ASCII in bulk and decode only the rest.
+  for (auto p = begin; (p = find_escape_candidate(p, end)) != end;) {
+    auto next = end;
+    for_each_codepoint(string_view(p, to_unsigned(end - p)),
+                       [&](uint32_t cp, string_view sv) {
+                         if (needs_escape(cp)) {
+                           result = {sv.begin(), sv.end(), cp};
+                           return false;
+                         }
+                         if ((static_cast<unsigned char>(*sv.data()) & 0x80) ==
+                             0) {
+                           next = sv.data();
+                           return false;
+                         }
+                         return true;
+                       });
+    if (result.end) break;
+    p = next;
+  }
   return result;
 }
 
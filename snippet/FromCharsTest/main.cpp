@@ -0,0 +1,263 @@
+// Checks that fmt::from_chars parses the output of fmt::format back to the
+// same value and agrees with strtod/strtoll, then measures its throughput.
+// Usage: FromCharsTest [count]; build with optimizations for the timings.
+
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "include/format.h"
+
+static int failures = 0;
+
+static void fail(const std::string &message)
+{
+    if (++failures <= 20)
+        std::cerr << "FAIL: " << message << '\n';
+}
+
+static std::uint64_t bits_of(double d)
+{
+    std::uint64_t bits;
+    std::memcpy(&bits, &d, sizeof(d));
+    return bits;
+}
+
+static double double_of(std::uint64_t bits)
+{
+    double d;
+    std::memcpy(&d, &bits, sizeof(d));
+    return d;
+}
+
+template <typename T>
+static void check_int_round_trip(T value)
+{
+    auto s = fmt::format("{}", value);
+    T parsed = 0;
+    auto result = fmt::from_chars(s.data(), s.data() + s.size(), parsed);
+    if (result.ec != std::errc() || result.ptr != s.data() + s.size() ||
+        parsed != value)
+        fail("integer round trip of " + s);
+}
+
+template <typename T>
+static void check_int_error(const std::string &s, std::errc ec)
+{
+    T parsed = 42;
+    auto result = fmt::from_chars(s.data(), s.data() + s.size(), parsed);
+    if (result.ec != ec || parsed != 42)
+        fail("expected an error for \"" + s + "\"");
+}
+
+template <typename T>
+static void check_int_limits()
+{
+    check_int_round_trip(std::numeric_limits<T>::min());
+    check_int_round_trip(std::numeric_limits<T>::max());
+    check_int_round_trip(T(0));
+    // One past either limit is out of range.
+    auto max = fmt::format("{}", std::numeric_limits<T>::max());
+    ++max.back();
+    check_int_error<T>(max, std::errc::result_out_of_range);
+    check_int_error<T>(max + "0", std::errc::result_out_of_range);
+    if (std::numeric_limits<T>::is_signed)
+    {
+        auto min = fmt::format("{}", std::numeric_limits<T>::min());
+        ++min.back();
+        check_int_error<T>(min, std::errc::result_out_of_range);
+    }
+    check_int_error<T>("", std::errc::invalid_argument);
+    check_int_error<T>("-", std::errc::invalid_argument);
+    check_int_error<T>("+1", std::errc::invalid_argument);
+    check_int_error<T>(" 1", std::errc::invalid_argument);
+}
+
+static void check_double(const std::string &s, double expected)
+{
+    double parsed = 0;
+    auto result = fmt::from_chars(s.data(), s.data() + s.size(), parsed);
+    if (result.ec != std::errc() || result.ptr != s.data() + s.size() ||
+        bits_of(parsed) != bits_of(expected))
+        fail(fmt::format("parsing \"{}\" gave {} instead of {}", s, parsed,
+                         expected));
+}
+
+// Parses s with both fmt::from_chars and strtod and compares the results.
+static void check_double_against_strtod(const std::string &s)
+{
+    errno = 0;
+    double expected = std::strtod(s.c_str(), nullptr);
+    if (errno == ERANGE)
+        return;
+    check_double(s, expected);
+}
+
+static void check_double_round_trip(double value)
+{
+    // The shortest representation must parse back to the same bits.
+    check_double(fmt::format("{}", value), value);
+    check_double(fmt::format("{:e}", value), std::strtod(
+        fmt::format("{:e}", value).c_str(), nullptr));
+    check_double(fmt::format("{:.17g}", value), value);
+    for (int precision : {0, 1, 5, 15, 16, 20, 40})
+        check_double_against_strtod(fmt::format("{:.{}e}", value, precision));
+}
+
+static void check_double_special_cases()
+{
+    const double values[] = {
+        0.0, -0.0, 1.0, 0.1, 0.3, 1e23, 9007199254740993.0,
+        std::numeric_limits<double>::min(),
+        std::numeric_limits<double>::denorm_min(),
+        std::numeric_limits<double>::max(),
+        std::numeric_limits<double>::epsilon(),
+        double_of(0x000fffffffffffff), // largest subnormal
+    };
+    for (double value : values)
+    {
+        check_double_round_trip(value);
+        check_double_round_trip(-value);
+    }
+    check_double("inf", std::numeric_limits<double>::infinity());
+    check_double("-Infinity", -std::numeric_limits<double>::infinity());
+    // Halfway cases that need more than 19 significant digits to resolve.
+    check_double_against_strtod("9007199254740993.00000000000000000001");
+    check_double_against_strtod("2.4703282292062327208828439643411068618e-324");
+    check_double_against_strtod("1.7976931348623158079372897140530341507e308");
+
+    double nan = 0;
+    std::string s = "nan";
+    if (fmt::from_chars(s.data(), s.data() + s.size(), nan).ec != std::errc() ||
+        !std::isnan(nan))
+        fail("parsing \"nan\"");
+    double parsed = 42;
+    for (const char *bad : {"", "-", ".", "e5", "+1", " 1"})
+    {
+        s = bad;
+        if (fmt::from_chars(s.data(), s.data() + s.size(), parsed).ec !=
+                std::errc::invalid_argument ||
+            parsed != 42)
+            fail(fmt::format("expected an error for \"{}\"", s));
+    }
+    for (const char *out_of_range : {"1e400", "1e-400"})
+    {
+        s = out_of_range;
+        if (fmt::from_chars(s.data(), s.data() + s.size(), parsed).ec !=
+            std::errc::result_out_of_range)
+            fail(fmt::format("expected out of range for \"{}\"", s));
+    }
+}
+
+template <typename F>
+static double ns_per_value(const std::vector<std::string> &inputs, F parse)
+{
+    double best = std::numeric_limits<double>::max();
+    for (int run = 0; run < 5; ++run)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (const auto &s : inputs)
+            parse(s);
+        std::chrono::duration<double, std::nano> elapsed =
+            std::chrono::steady_clock::now() - start;
+        best = std::min(best, elapsed.count() /
+                                  static_cast<double>(inputs.size()));
+    }
+    return best;
+}
+
+static volatile double double_sink;
+static volatile long long int_sink;
+
+static void benchmark(int count, std::mt19937_64 &rng)
+{
+    std::vector<std::string> doubles, prices, ints;
+    std::uniform_real_distribution<double> price(0, 10000);
+    for (int i = 0; i < count; ++i)
+    {
+        double d;
+        do
+            d = double_of(rng());
+        while (!std::isfinite(d));
+        doubles.push_back(fmt::format("{}", d));
+        prices.push_back(fmt::format("{:.2f}", price(rng)));
+        ints.push_back(fmt::format("{}", static_cast<long long>(rng())));
+    }
+
+    auto strtod_parse = [](const std::string &s)
+    { double_sink = std::strtod(s.c_str(), nullptr); };
+    auto fmt_double_parse = [](const std::string &s)
+    {
+        double d = 0;
+        fmt::from_chars(s.data(), s.data() + s.size(), d);
+        double_sink = d;
+    };
+    auto strtoll_parse = [](const std::string &s)
+    { int_sink = std::strtoll(s.c_str(), nullptr, 10); };
+    auto fmt_int_parse = [](const std::string &s)
+    {
+        long long n = 0;
+        fmt::from_chars(s.data(), s.data() + s.size(), n);
+        int_sink = n;
+    };
+
+    fmt::print("{:<28}{:>12}{:>16}\n", "input", "strtod ns", "from_chars ns");
+    fmt::print("{:<28}{:>12.1f}{:>16.1f}\n", "shortest random doubles",
+               ns_per_value(doubles, strtod_parse),
+               ns_per_value(doubles, fmt_double_parse));
+    fmt::print("{:<28}{:>12.1f}{:>16.1f}\n", "prices {:.2f}",
+               ns_per_value(prices, strtod_parse),
+               ns_per_value(prices, fmt_double_parse));
+    fmt::print("{:<28}{:>12.1f}{:>16.1f}\n", "int64 (vs strtoll)",
+               ns_per_value(ints, strtoll_parse),
+               ns_per_value(ints, fmt_int_parse));
+}
+
+int main(int argc, char **argv)
+{
+    int count = argc > 1 ? std::atoi(argv[1]) : 100000;
+    std::mt19937_64 rng(42);
+
+    check_int_limits<signed char>();
+    check_int_limits<unsigned char>();
+    check_int_limits<short>();
+    check_int_limits<int>();
+    check_int_limits<unsigned>();
+    check_int_limits<long long>();
+    check_int_limits<unsigned long long>();
+    check_double_special_cases();
+
+    for (int i = 0; i < count; ++i)
+    {
+        auto bits = rng();
+        check_int_round_trip(static_cast<long long>(bits));
+        check_int_round_trip(static_cast<int>(bits >> (bits % 32)));
+        check_int_round_trip(bits >> (bits % 64));
+
+        double d = double_of(bits);
+        if (std::isfinite(d))
+            check_double_round_trip(d);
+        // Short decimal inputs like those found in text formats.
+        check_double_against_strtod(
+            fmt::format("{}.{}e{}", static_cast<int>(bits % 100000),
+                        static_cast<int>((bits >> 20) % 1000),
+                        static_cast<int>((bits >> 40) % 61) - 30));
+    }
+
+    if (failures != 0)
+    {
+        std::cerr << failures << " failures\n";
+        return 1;
+    }
+    fmt::print("{} round trips passed\n", count);
+    benchmark(count, rng);
+    return 0;
+}
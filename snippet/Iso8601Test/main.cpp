@@ -0,0 +1,93 @@
+// Checks that fmt::iso8601 agrees with formatting the result of fmt::gmtime
+// for random time points of different precisions, including the extremes.
+// Usage: Iso8601Test [count]
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+
+#include "include/chrono.h"
+
+using sys_clock = std::chrono::system_clock;
+
+static int failures = 0;
+
+// Formats count ticks of a duration with den ticks per second through
+// fmt::gmtime with the fraction of a second computed separately.
+static std::string expected_iso8601(long long count, long long den,
+                                    int num_digits)
+{
+    auto secs = count / den;
+    auto frac = count % den;
+    if (frac < 0)
+    {
+        frac += den;
+        --secs;
+    }
+    auto s = fmt::format("{:%Y-%m-%dT%H:%M:%S}",
+                         fmt::gmtime(static_cast<std::time_t>(secs)));
+    if (num_digits > 0)
+        s += fmt::format(".{:0{}}", frac, num_digits);
+    return s + "Z";
+}
+
+template <typename Duration>
+static void check(long long count, long long den, int num_digits)
+{
+    auto t = std::chrono::time_point<sys_clock, Duration>(Duration(count));
+    auto actual = fmt::format("{}", fmt::iso8601(t));
+    auto expected = expected_iso8601(count, den, num_digits);
+    if (actual != expected && ++failures <= 20)
+        std::cerr << "FAIL: " << count << " ticks of 1/" << den << " s: "
+                  << actual << " != " << expected << '\n';
+    // Fill, align and width apply to the whole timestamp.
+    if (fmt::format("{:*^40}", fmt::iso8601(t)) !=
+            fmt::format("{:*^40}", expected) &&
+        ++failures <= 20)
+        std::cerr << "FAIL: padding " << expected << '\n';
+}
+
+template <typename Duration>
+static void check_range(std::mt19937_64 &rng, int count, long long den,
+                        int num_digits, long long min, long long max)
+{
+    for (auto value : {min, min + 1, -den - 1, -den, -1LL, 0LL, 1LL, den,
+                       max - 1, max})
+        check<Duration>(value, den, num_digits);
+    std::uniform_int_distribution<long long> dist(min, max);
+    for (int i = 0; i < count; ++i)
+    {
+        auto value = dist(rng);
+        check<Duration>(value, den, num_digits);
+        // Times near the minimum exercise the floor of the seconds.
+        check<Duration>(min + static_cast<long long>(rng() % 1000000), den,
+                        num_digits);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    int count = argc > 1 ? std::atoi(argv[1]) : 200000;
+    std::mt19937_64 rng(42);
+    const auto min = std::numeric_limits<long long>::min();
+    const auto max = std::numeric_limits<long long>::max();
+
+    check_range<std::chrono::nanoseconds>(rng, count, 1000000000, 9, min, max);
+    check_range<std::chrono::microseconds>(rng, count, 1000000, 6, min, max);
+    check_range<std::chrono::milliseconds>(rng, count, 1000, 3, min, max);
+    // Seconds are limited to the years that fit in std::tm::tm_year.
+    const long long max_seconds = 60000000000000000;
+    check_range<std::chrono::seconds>(rng, count, 1, 0, -max_seconds,
+                                      max_seconds);
+
+    if (failures != 0)
+    {
+        std::cerr << failures << " failures\n";
+        return 1;
+    }
+    fmt::print("{} random time points per precision passed\n", count);
+    return 0;
+}
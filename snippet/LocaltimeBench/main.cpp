@@ -0,0 +1,74 @@
+// Measures the throughput of fmt::localtime with 1, 2, 4 and 8 threads for
+// times one second apart and for random times over 50 years. Build it as
+// LocaltimeBench and LocaltimeBenchCached to compare FMT_USE_LOCALTIME_CACHE
+// 0 and 1.
+// Usage: LocaltimeBench [calls per thread] [time zone]
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "include/chrono.h"
+
+using bench_clock = std::chrono::steady_clock;
+
+static std::atomic<long long> sink(0);
+
+static void convert(const std::vector<std::time_t> &times)
+{
+    long long sum = 0;
+    for (auto t : times)
+        sum += fmt::localtime(t).tm_hour;
+    sink += sum;
+}
+
+// Returns the total number of conversions per second of all threads.
+static double run(int num_threads, bool random, int calls)
+{
+    std::vector<std::vector<std::time_t>> times(
+        static_cast<size_t>(num_threads));
+    std::mt19937_64 rng(42);
+    const std::time_t start = 1600000000;
+    for (auto &thread_times : times)
+    {
+        auto offset = static_cast<std::time_t>(rng() % 1000000);
+        for (int i = 0; i < calls; ++i)
+            thread_times.push_back(
+                random ? start + static_cast<std::time_t>(rng() % 1576800000)
+                       : start + offset + i);
+    }
+    auto begin = bench_clock::now();
+    std::vector<std::thread> threads;
+    for (auto &thread_times : times)
+        threads.emplace_back(convert, std::cref(thread_times));
+    for (auto &thread : threads)
+        thread.join();
+    std::chrono::duration<double> elapsed = bench_clock::now() - begin;
+    return static_cast<double>(calls) * num_threads / elapsed.count();
+}
+
+int main(int argc, char **argv)
+{
+    int calls = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    const char *tz = argc > 2 ? argv[2] : "America/New_York";
+    setenv("TZ", tz, 1);
+    tzset();
+
+    fmt::print("FMT_USE_LOCALTIME_CACHE={}, TZ={}, {} hardware threads\n",
+               FMT_USE_LOCALTIME_CACHE, tz,
+               std::thread::hardware_concurrency());
+    fmt::print("{:>7}  {:>16}  {:>16}\n", "threads", "sequential M/s",
+               "random M/s");
+    for (int num_threads : {1, 2, 4, 8})
+    {
+        double sequential = run(num_threads, false, calls);
+        double random = run(num_threads, true, calls);
+        fmt::print("{:>7}  {:>16.1f}  {:>16.1f}\n", num_threads,
+                   sequential / 1e6, random / 1e6);
+    }
+    return 0;
+}
@@ -0,0 +1,104 @@
+// Checks that fmt formats x87 long double the same as snprintf for the e, f
+// and g presentations and the same as double with general precision 0.
+// Usage: LongDoubleTest [count]
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "include/format.h"
+
+static int failures = 0;
+
+static void check(const std::string &actual, const std::string &expected,
+                  const std::string &what)
+{
+    if (actual != expected && ++failures <= 20)
+        std::cerr << "FAIL: " << what << ": " << actual << " != " << expected
+                  << '\n';
+}
+
+static std::string sprintf_long_double(const char *format, int precision,
+                                       long double value)
+{
+    int size = std::snprintf(nullptr, 0, format, precision, value);
+    std::vector<char> buf(static_cast<size_t>(size) + 1);
+    std::snprintf(buf.data(), buf.size(), format, precision, value);
+    return std::string(buf.data(), static_cast<size_t>(size));
+}
+
+// fmt's general presentation differs from printf's %g in the layout of
+// precision 0 (9.5 is "10" and not "1e+01") and of # ("125.0" and not
+// "125."), for double as well, so only g from precision 1 is compared.
+static void check_against_snprintf(long double value, int precision,
+                                   bool fixed)
+{
+    auto what = fmt::format("{:a} with precision {}", value, precision);
+    check(fmt::format("{:.{}e}", value, precision),
+          sprintf_long_double("%.*Le", precision, value), "e " + what);
+    if (precision > 0)
+        check(fmt::format("{:.{}g}", value, precision),
+              sprintf_long_double("%.*Lg", precision, value), "g " + what);
+    if (fixed)
+        check(fmt::format("{:.{}f}", value, precision),
+              sprintf_long_double("%.*Lf", precision, value), "f " + what);
+}
+
+// Precision 0 with the general presentation gives one digit like for double.
+static void check_precision0(double value)
+{
+    auto ld = static_cast<long double>(value);
+    for (const char *format : {"{:.0}", "{:.0g}", "{:#.0g}"})
+        check(fmt::format(fmt::runtime(format), ld),
+              fmt::format(fmt::runtime(format), value),
+              fmt::format("{} of {}", format, value));
+}
+
+int main(int argc, char **argv)
+{
+    if (std::numeric_limits<long double>::digits != 64)
+    {
+        fmt::print("long double is not x87 80-bit, nothing to check\n");
+        return 0;
+    }
+    int count = argc > 1 ? std::atoi(argv[1]) : 100000;
+
+    const double values[] = {5.0, 9.5, 123.456, 1e20, 0.95, 0.0, 1e-5, 99.5,
+                             1e300};
+    for (double value : values)
+    {
+        check_precision0(value);
+        check_precision0(-value);
+        check_against_snprintf(value, 0, true);
+        check_against_snprintf(-value, 0, true);
+    }
+    check_against_snprintf(1e4000L, 0, false);
+
+    std::mt19937_64 rng(42);
+    for (int i = 0; i < count; ++i)
+    {
+        // Random 64-bit significands over the whole exponent range, with
+        // more values near 1 where fixed output is short.
+        auto significand = static_cast<long double>(rng() | (1ULL << 63));
+        int exp = rng() % 4 == 0 ? static_cast<int>(rng() % 32767) - 16446
+                                 : static_cast<int>(rng() % 400) - 263;
+        auto value = std::ldexp(significand, exp);
+        if (!std::isfinite(value))
+            continue;
+        int precision = static_cast<int>(rng() % 25);
+        check_against_snprintf(value, precision, std::fabs(value) < 1e30L);
+    }
+
+    if (failures != 0)
+    {
+        std::cerr << failures << " failures\n";
+        return 1;
+    }
+    fmt::print("{} long double values match snprintf\n", count);
+    return 0;
+}
@@ -0,0 +1,101 @@
+// Checks that the East Asian Width table used by fmt's compute_width agrees
+// with support/east-asian-width.py for every code point.
+// Usage: support/east-asian-width.py --ranges [EastAsianWidth.txt] | WidthTest
+
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "include/format.h"
+
+static const std::uint32_t max_code_point = 0x110000;
+
+static std::string to_utf8(std::uint32_t cp)
+{
+    std::string s;
+    if (cp < 0x80)
+    {
+        s += static_cast<char>(cp);
+    }
+    else if (cp < 0x800)
+    {
+        s += static_cast<char>(0xc0 | (cp >> 6));
+        s += static_cast<char>(0x80 | (cp & 0x3f));
+    }
+    else if (cp < 0x10000)
+    {
+        s += static_cast<char>(0xe0 | (cp >> 12));
+        s += static_cast<char>(0x80 | ((cp >> 6) & 0x3f));
+        s += static_cast<char>(0x80 | (cp & 0x3f));
+    }
+    else
+    {
+        s += static_cast<char>(0xf0 | (cp >> 18));
+        s += static_cast<char>(0x80 | ((cp >> 12) & 0x3f));
+        s += static_cast<char>(0x80 | ((cp >> 6) & 0x3f));
+        s += static_cast<char>(0x80 | (cp & 0x3f));
+    }
+    return s;
+}
+
+int main()
+{
+    // Read the wide ranges printed by east-asian-width.py --ranges.
+    std::vector<bool> wide(max_code_point);
+    unsigned first = 0, last = 0;
+    size_t num_ranges = 0;
+    while (std::scanf("%x..%x", &first, &last) == 2)
+    {
+        if (first > last || last >= max_code_point)
+        {
+            std::cerr << "invalid range " << first << ".." << last << '\n';
+            return 1;
+        }
+        for (auto cp = first; cp <= last; ++cp)
+            wide[cp] = true;
+        ++num_ranges;
+    }
+    if (num_ranges == 0)
+    {
+        std::cerr << "no ranges on stdin, run "
+                     "support/east-asian-width.py --ranges | WidthTest\n";
+        return 1;
+    }
+
+    int failures = 0;
+    for (std::uint32_t cp = 0x20; cp < max_code_point; ++cp)
+    {
+        if (cp >= 0xd800 && cp <= 0xdfff)
+            continue; // Surrogates are not valid in UTF-8.
+        auto s = to_utf8(cp);
+        size_t expected = wide[cp] ? 2 : 1;
+        // Check both a lone code point and one following ASCII text, which
+        // goes through the ASCII fast path first.
+        auto width = fmt::detail::compute_width(fmt::string_view(s));
+        auto prefixed = fmt::detail::compute_width(
+            fmt::string_view("abc" + s));
+        if (width != expected || prefixed != expected + 3)
+        {
+            if (++failures <= 20)
+                std::cerr << fmt::format("FAIL: U+{:04X} has width {}, "
+                                         "expected {}\n",
+                                         cp, width, expected);
+        }
+    }
+    if (fmt::format("{:>4}", to_utf8(0x4e00)) != "  " + to_utf8(0x4e00))
+    {
+        std::cerr << "FAIL: padding of a wide character\n";
+        ++failures;
+    }
+
+    if (failures != 0)
+    {
+        std::cerr << failures << " failures\n";
+        return 1;
+    }
+    fmt::print("{} wide ranges checked against all code points\n",
+               num_ranges);
+    return 0;
+}
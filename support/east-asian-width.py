@@ -0,0 +1,116 @@
+#!/usr/bin/env python3
+
+# This script generates the East Asian Width tables used by compute_width in
+# include/format.h.
+#
+# Usage: east-asian-width.py [--ranges] [EastAsianWidth.txt]
+#
+# With --ranges the wide code points are printed as first..last hex ranges
+# instead of the tables, for checking the tables with snippet/WidthTest.
+#
+# EastAsianWidth.txt can be downloaded from
+# https://www.unicode.org/Public/UCD/latest/ucd/EastAsianWidth.txt.
+# If it is omitted, the data from Python's unicodedata module is used.
+
+import sys
+
+MAX_CODE_POINT = 0x110000
+BLOCK_BITS = 8
+BLOCK_SIZE = 1 << BLOCK_BITS
+
+# Ranges whose unassigned code points default to wide, see the @missing lines
+# in EastAsianWidth.txt.
+DEFAULT_WIDE = [(0x3400, 0x4dbf), (0x4e00, 0x9fff), (0xf900, 0xfaff),
+                (0x20000, 0x2fffd), (0x30000, 0x3fffd)]
+
+
+def read_ucd(path):
+  wide = [False] * MAX_CODE_POINT
+  for first, last in DEFAULT_WIDE:
+    for cp in range(first, last + 1):
+      wide[cp] = True
+  with open(path) as f:
+    for line in f:
+      line = line.split('#')[0].strip()
+      if not line:
+        continue
+      cps, width = [s.strip() for s in line.split(';')]
+      cps = [int(cp, 16) for cp in cps.split('..')]
+      for cp in range(cps[0], cps[-1] + 1):
+        wide[cp] = width in ('W', 'F')
+  return wide
+
+
+def read_unicodedata():
+  import unicodedata
+  wide = [False] * MAX_CODE_POINT
+  for first, last in DEFAULT_WIDE:
+    for cp in range(first, last + 1):
+      wide[cp] = True
+  for cp in range(MAX_CODE_POINT):
+    c = chr(cp)
+    # unicodedata reports arbitrary widths for unassigned code points.
+    if unicodedata.category(c) != 'Cn':
+      wide[cp] = unicodedata.east_asian_width(c) in ('W', 'F')
+  return wide
+
+
+def print_ranges(wide):
+  cp = 0
+  while cp < MAX_CODE_POINT:
+    if not wide[cp]:
+      cp += 1
+      continue
+    first = cp
+    while cp < MAX_CODE_POINT and wide[cp]:
+      cp += 1
+    print('{:04X}..{:04X}'.format(first, cp - 1))
+
+
+def main(args):
+  ranges = '--ranges' in args
+  args = [arg for arg in args if arg != '--ranges']
+  wide = read_ucd(args[0]) if args else read_unicodedata()
+  if ranges:
+    print_ranges(wide)
+    return
+  end = max(cp for cp in range(MAX_CODE_POINT) if wide[cp]) + 1
+  num_blocks = (end + BLOCK_SIZE - 1) >> BLOCK_BITS
+
+  # Split code points into blocks of 256 bits and deduplicate them.
+  blocks = []
+  block_index = {}
+  index = []
+  for b in range(num_blocks):
+    words = []
+    for w in range(BLOCK_SIZE // 64):
+      word = 0
+      for bit in range(64):
+        cp = (b << BLOCK_BITS) + w * 64 + bit
+        if cp < MAX_CODE_POINT and wide[cp]:
+          word |= 1 << bit
+      words.append(word)
+    words = tuple(words)
+    if words not in block_index:
+      block_index[words] = len(blocks)
+      blocks.append(words)
+    index.append(block_index[words])
+  assert len(blocks) <= 256
+
+  print('  // Code points >= {:#x} are not wide.'.format(
+      num_blocks << BLOCK_BITS))
+  print('  static constexpr uint8_t wide_index[{}] = {{'.format(len(index)))
+  for i in range(0, len(index), 16):
+    print('      ' + ' '.join(
+        '{},'.format(v) for v in index[i:i + 16]))
+  print('  };')
+  print('  static constexpr uint64_t wide_blocks[{}] = {{'.format(
+      len(blocks) * (BLOCK_SIZE // 64)))
+  words = [w for block in blocks for w in block]
+  for i in range(0, len(words), 3):
+    print('      ' + ' '.join('{:#018x},'.format(w) for w in words[i:i + 3]))
+  print('  };')
+
+
+if __name__ == '__main__':
+  main(sys.argv[1:])